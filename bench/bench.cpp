@@ -0,0 +1,511 @@
+// Measures the C parser and snot::document on the given files.
+//
+// usage: snot_bench [-r repeat] [-o results.json] file...
+//
+// Every case prints one JSON object per line, to stdout or to the -o file,
+// and a summary to stderr. Times are the best of the repeats. On Linux the
+// mispredicted branches are counted too, where the hardware allows it.
+
+#include <snot.hpp>
+
+#include "reference.h"
+#include "utf8.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// calls to operator new and to the alloc and grow callbacks
+size_t allocation_count = 0;
+
+// counts the mispredicted branches of this thread, -1 when unavailable
+int branch_counter = -1;
+
+struct result
+{
+    SNOT_RESULT code      = SNOT_OK;
+    double seconds        = 0;
+    size_t bytes          = 0;
+    size_t events         = 0;
+    size_t allocations    = 0;
+    int64_t branch_misses = -1; // of the fastest repeat, -1 when not counted
+};
+
+// virtual machines and containers often have no counters to open
+void open_branch_counter()
+{
+#ifdef __linux__
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = PERF_COUNT_HW_BRANCH_MISSES;
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    branch_counter = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+void start_branch_counter()
+{
+#ifdef __linux__
+    if (branch_counter >= 0)
+    {
+        ioctl(branch_counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(branch_counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+int64_t stop_branch_counter()
+{
+#ifdef __linux__
+    uint64_t count;
+
+    if (branch_counter >= 0)
+    {
+        ioctl(branch_counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(branch_counter, &count, sizeof(count)) == sizeof(count))
+            return (int64_t)count;
+    }
+#endif
+    return -1;
+}
+
+// the process peak, so a case reports the largest footprint so far
+size_t peak_rss_kb()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(
+            GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+void *counted_alloc(size_t size)
+{
+    allocation_count++;
+    return malloc(size);
+}
+
+void *counted_grow(void *memory, size_t *size, size_t grow_size)
+{
+    allocation_count++;
+    *size += grow_size;
+    return realloc(memory, *size);
+}
+
+void count_event(SNOT_PARSER *, size_t, void *userdata)
+{
+    (*(size_t *)userdata)++;
+}
+
+void count_batch(SNOT_PARSER *,
+                 const SNOT_EVENT *,
+                 size_t count,
+                 void *userdata)
+{
+    *(size_t *)userdata += count;
+}
+
+// looks every node up by name in its parent, counting the lookups
+void look_up(const snot::node &n, size_t *lookups)
+{
+    for (const auto &c : n)
+    {
+        if (n.has(c.name()))
+            (*lookups)++;
+        look_up(c, lookups);
+    }
+}
+
+// keeps the conversions of read_numbers from being optimized away
+volatile double number_sink;
+
+// reads every number as an integer and as a double, counting the reads
+void read_numbers(const snot::node &n, size_t *reads, double *sum)
+{
+    for (const auto &v : n.content())
+    {
+        if (v.is_number())
+        {
+            *sum += (double)v.get_value<int64_t>() + v.get_value<double>();
+            *reads += 2;
+        }
+    }
+    for (const auto &c : n)
+        read_numbers(c, reads, sum);
+}
+
+SNOT_PARSER *create_parser(size_t *events)
+{
+    SNOT_CALLBACKS cx;
+
+    cx.alloc         = counted_alloc;
+    cx.free          = free;
+    cx.grow          = counted_grow;
+    cx.shrink        = nullptr;
+    cx.start_section = count_event;
+    cx.end_section   = count_event;
+    cx.string        = count_event;
+    cx.number        = count_event;
+
+    return snot_create(cx, events);
+}
+
+// the raw C parser, with callbacks or with batches
+result parse(const std::string &contents, bool batch)
+{
+    result r;
+    SNOT_PARSER *parser = create_parser(&r.events);
+
+    if (batch && snot_set_batch(parser, count_batch, 0) != SNOT_OK)
+        r.code = SNOT_ERROR_NO_MEMORY;
+    if (r.code == SNOT_OK)
+        r.code = snot_parse_buffer(
+            parser, contents.data(), contents.size(), nullptr);
+    if (r.code == SNOT_OK)
+        r.code = snot_end(parser);
+
+    snot_free(parser);
+    r.bytes = contents.size();
+    return r;
+}
+
+// the C parser fed one code point at a time, as the reference lexer is
+result parse_code_points(const std::string &contents)
+{
+    const unsigned char *s   = (const unsigned char *)contents.data();
+    const unsigned char *end = s + contents.size();
+    result r;
+    SNOT_PARSER *parser = create_parser(&r.events);
+    uint32_t c;
+
+    while (s < end && r.code == SNOT_OK)
+    {
+        s += bench_decode_utf8(s, end - s, &c);
+        r.code = snot_parse(parser, c);
+    }
+    if (r.code == SNOT_OK)
+        r.code = snot_end(parser);
+
+    snot_free(parser);
+    r.bytes = contents.size();
+    return r;
+}
+
+// the switch-based lexer of snot 0.1.0, which rejects some of the newer
+// syntax; its speed is then measured on the bytes it got through
+result parse_reference(const std::string &contents)
+{
+    result r;
+
+    if (!snot_reference_parse(contents.data(),
+                              contents.size(),
+                              &r.bytes,
+                              &r.events,
+                              &allocation_count))
+        r.code = SNOT_ERROR_INVALID_CHARACTER;
+    return r;
+}
+
+template <typename F> result measure(int repeat, F run)
+{
+    result best;
+
+    for (int i = 0; i < repeat; i++)
+    {
+        allocation_count = 0;
+        start_branch_counter();
+        const auto start = std::chrono::steady_clock::now();
+        result r         = run();
+        const auto end   = std::chrono::steady_clock::now();
+
+        r.branch_misses = stop_branch_counter();
+        r.seconds       = std::chrono::duration<double>(end - start).count();
+        r.allocations   = allocation_count;
+        if (i == 0 || r.seconds < best.seconds)
+            best = r;
+    }
+
+    return best;
+}
+
+std::string json_string(const std::string &s)
+{
+    std::string quoted = "\"";
+
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+
+    return quoted + "\"";
+}
+
+void report(FILE *out,
+            const std::string &file,
+            const char *name,
+            const result &r)
+{
+    const double seconds = r.seconds > 0 ? r.seconds : 1e-9;
+    char misses[32]      = "null";
+
+    if (r.branch_misses >= 0 && r.bytes)
+        snprintf(misses,
+                 sizeof(misses),
+                 "%.4f",
+                 (double)r.branch_misses / r.bytes);
+
+    fprintf(out,
+            "{\"file\": %s, \"case\": \"%s\", \"result\": %d, "
+            "\"bytes\": %zu, \"seconds\": %.6f, \"mb_per_s\": %.2f, "
+            "\"events\": %zu, \"events_per_s\": %.0f, \"allocations\": %zu, "
+            "\"branch_misses_per_byte\": %s, \"peak_rss_kb\": %zu}\n",
+            json_string(file).c_str(),
+            name,
+            (int)r.code,
+            r.bytes,
+            r.seconds,
+            r.bytes / seconds / 1e6,
+            r.events,
+            r.events / seconds,
+            r.allocations,
+            misses,
+            peak_rss_kb());
+    fflush(out);
+
+    fprintf(stderr,
+            "%-24s %-23s %9.2f MB/s %12.0f events/s %9zu allocs %8s "
+            "misses/B%s\n",
+            file.c_str(),
+            name,
+            r.bytes / seconds / 1e6,
+            r.events / seconds,
+            r.allocations,
+            misses,
+            r.code == SNOT_OK ? "" : "  FAILED");
+}
+
+#ifdef SNOT_HAS_PMR
+// the arenas of snot::pmr::document take their blocks from here
+class counted_resource : public std::pmr::memory_resource
+{
+    void *do_allocate(size_t size, size_t align) override
+    {
+        allocation_count++;
+        return std::pmr::new_delete_resource()->allocate(size, align);
+    }
+
+    void do_deallocate(void *memory, size_t size, size_t align) override
+    {
+        std::pmr::new_delete_resource()->deallocate(memory, size, align);
+    }
+
+    bool do_is_equal(const memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+#endif
+
+int usage()
+{
+    fprintf(stderr,
+            "usage: snot_bench [-r repeat] [-o results.json] file...\n");
+    return 2;
+}
+} // namespace
+
+// counts the allocations of snot::document, its parsers use malloc directly
+void *operator new(size_t size)
+{
+    allocation_count++;
+    if (void *memory = malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { free(memory); }
+
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+
+int main(int argc, char **argv)
+{
+    FILE *out  = stdout;
+    int repeat = 5;
+    int i;
+
+#ifdef SNOT_HAS_PMR
+    static counted_resource counted;
+    std::pmr::set_default_resource(&counted);
+#endif
+    open_branch_counter();
+
+    for (i = 1; i + 1 < argc && argv[i][0] == '-'; i += 2)
+    {
+        if (!strcmp(argv[i], "-r"))
+            repeat = std::max(1, atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "-o"))
+        {
+            out = fopen(argv[i + 1], "w");
+            if (!out)
+            {
+                fprintf(stderr, "cannot open %s\n", argv[i + 1]);
+                return 1;
+            }
+        }
+        else
+            return usage();
+    }
+    if (i >= argc)
+        return usage();
+
+    for (; i < argc; i++)
+    {
+        const std::string file  = argv[i];
+        const std::string saved = file + ".saved";
+        std::ifstream stream(file, std::ios::binary);
+        if (!stream)
+        {
+            fprintf(stderr, "cannot open %s\n", file.c_str());
+            return 1;
+        }
+        const std::string contents((std::istreambuf_iterator<char>(stream)),
+                                   std::istreambuf_iterator<char>());
+
+        const result callbacks =
+            measure(repeat, [&] { return parse(contents, false); });
+        report(out, file, "c_parse_callbacks", callbacks);
+
+        report(out,
+               file,
+               "c_parse_batch",
+               measure(repeat, [&] { return parse(contents, true); }));
+
+        // both lexers alone, without the bulk paths of snot_parse_buffer
+        report(out,
+               file,
+               "c_code_points",
+               measure(repeat, [&] { return parse_code_points(contents); }));
+
+        report(out,
+               file,
+               "reference_code_points",
+               measure(repeat, [&] { return parse_reference(contents); }));
+
+        // the tree holds about one node or value per event, and freeing it
+        // is part of the time
+        report(out, file, "document_load_file", measure(repeat, [&] {
+                   snot::document doc;
+                   result r;
+                   r.code   = doc.load_file(file).code;
+                   r.bytes  = contents.size();
+                   r.events = callbacks.events;
+                   return r;
+               }));
+
+#ifdef SNOT_HAS_PMR
+        // the same tree in an arena, released at once
+        report(out, file, "pmr_document_load_file", measure(repeat, [&] {
+                   snot::pmr::document doc;
+                   result r;
+                   r.code   = doc.load_file(file).code;
+                   r.bytes  = contents.size();
+                   r.events = callbacks.events;
+                   return r;
+               }));
+#endif
+
+#ifdef SNOT_HAS_STRING_VIEW
+        // names and values borrowed from the mapped file
+        report(out, file, "view_document_load_file", measure(repeat, [&] {
+                   snot::view::document doc;
+                   result r;
+                   r.code   = doc.load_file(file).code;
+                   r.bytes  = contents.size();
+                   r.events = callbacks.events;
+                   return r;
+               }));
+#endif
+
+        snot::document doc;
+        doc.load_file(file);
+        result save = measure(repeat, [&] {
+            result r;
+            if (!doc.save_file(saved))
+                r.code = SNOT_ERROR_PARTIAL;
+            r.events = callbacks.events;
+            return r;
+        });
+
+        // wide sections are indexed while they are loaded
+        report(out, file, "node_lookup", measure(repeat, [&] {
+                   result r;
+                   r.bytes = contents.size();
+                   if (doc.root())
+                       look_up(*doc.root(), &r.events);
+                   return r;
+               }));
+
+        report(out, file, "value_get_value", measure(repeat, [&] {
+                   result r;
+                   double sum = 0;
+                   r.bytes    = contents.size();
+                   if (doc.root())
+                       read_numbers(*doc.root(), &r.events, &sum);
+                   number_sink = sum;
+                   return r;
+               }));
+
+        // throughput of what was written
+        std::ifstream written(saved, std::ios::binary | std::ios::ate);
+        if (written)
+            save.bytes = (size_t)written.tellg();
+        written.close();
+        std::remove(saved.c_str());
+        report(out, file, "document_save_file", save);
+    }
+
+    if (out != stdout)
+        fclose(out);
+
+    return 0;
+}
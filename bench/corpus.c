@@ -0,0 +1,279 @@
+/*
+ * Generates synthetic SNOT documents for snot_bench.
+ *
+ * usage: snot_corpus KIND [options]
+ *
+ * KIND is one of wide, deep, strings, numbers, continuations or mixed. The
+ * output is made of top-level records and is the same for the same options,
+ * so results can be compared between releases.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct _CORPUS
+{
+    FILE *out;
+    unsigned long size;  /* bytes to write, the last record may pass it */
+    unsigned long width; /* children of a section, values of an array */
+    unsigned long depth; /* nested groups */
+    unsigned long length; /* bytes of a long string */
+    unsigned long seed;
+    unsigned long written;
+} CORPUS;
+
+typedef void (*CORPUS_RECORD)(CORPUS *c, unsigned long n);
+
+/* keys repeat, as they do in configuration files */
+static const char *const _keys[] = {
+    "servlet-name", "servlet-class", "init-param", "templatePath",
+    "cachePackageTagsTrack", "useJSP", "dataStoreClass", "maxUrlLength",
+    "configGlossary:adminEmail", "mailHost", "title", "GlossTerm", "para",
+    "Abbrev", "SortAs", "url-pattern"};
+
+static const char *const _words[] = {
+    "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+    "hotel", "india", "juliett", "kilo", "lima", "mike", "november"};
+
+#define _COUNT(a) (sizeof(a) / sizeof(*(a)))
+
+/* xorshift32, the seed alone decides the output */
+static unsigned long _random(CORPUS *c)
+{
+    unsigned long x = c->seed;
+
+    x ^= (x << 13) & 0xFFFFFFFFUL;
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xFFFFFFFFUL;
+    c->seed = x;
+
+    return x;
+}
+
+static void _write(CORPUS *c, const char *s)
+{
+    const size_t length = strlen(s);
+
+    fwrite(s, 1, length, c->out);
+    c->written += length;
+}
+
+static void _indent(CORPUS *c, unsigned long level)
+{
+    while (level--)
+        _write(c, "  ");
+}
+
+static const char *_key(CORPUS *c)
+{
+    return _keys[_random(c) % _COUNT(_keys)];
+}
+
+static const char *_word(CORPUS *c)
+{
+    return _words[_random(c) % _COUNT(_words)];
+}
+
+/* a section with width key value pairs */
+static void _wide(CORPUS *c, unsigned long n)
+{
+    char buffer[64];
+    unsigned long i;
+
+    sprintf(buffer, "record%lu\n", n);
+    _write(c, buffer);
+    for (i = 0; i < c->width; i++)
+    {
+        _indent(c, 1);
+        _write(c, _key(c));
+        _write(c, " ");
+        _write(c, _word(c));
+        _write(c, ";\n");
+    }
+    _write(c, ",\n");
+}
+
+/* a section in depth nested groups, each one opened by a section */
+static void _deep(CORPUS *c, unsigned long n)
+{
+    char buffer[64];
+    unsigned long i;
+
+    sprintf(buffer, "tree%lu\n", n);
+    _write(c, buffer);
+    for (i = 1; i <= c->depth; i++)
+    {
+        _indent(c, i);
+        _write(c, _key(c));
+        _write(c, " (\n");
+    }
+    _indent(c, c->depth + 1);
+    _write(c, "leaf ");
+    _write(c, _word(c));
+    _write(c, ";\n");
+    for (i = c->depth; i > 0; i--)
+    {
+        _indent(c, i);
+        _write(c, "),\n");
+    }
+    _write(c, ",\n");
+}
+
+/* words of a quoted string of about length bytes, with escapes */
+static void _text(CORPUS *c, unsigned long length)
+{
+    static const char *const escapes[] = {
+        "\\n", "\\t", "\\\"", "\\\\", "\\101", "\\x41", "\\u00E9",
+        "\\U0001F600"};
+    unsigned long written = c->written + length;
+
+    while (c->written < written)
+    {
+        _write(c, _word(c));
+        if (_random(c) % 8)
+            _write(c, " ");
+        else
+            _write(c, escapes[_random(c) % _COUNT(escapes)]);
+    }
+}
+
+/* a long string */
+static void _strings(CORPUS *c, unsigned long n)
+{
+    char buffer[64];
+
+    sprintf(buffer, "text%lu \"", n);
+    _write(c, buffer);
+    _text(c, c->length);
+    _write(c, "\";\n");
+}
+
+/* an array of width decimal, hexadecimal and octal integers */
+static void _numbers(CORPUS *c, unsigned long n)
+{
+    char buffer[64];
+    unsigned long i;
+
+    sprintf(buffer, "values%lu (", n);
+    _write(c, buffer);
+    for (i = 0; i < c->width; i++)
+    {
+        const unsigned long value = _random(c);
+
+        if (i % 8 == 0)
+            _write(c, "\n  ");
+        switch (value % 4)
+        {
+        case 0:
+            sprintf(buffer, "0x%lX ", value);
+            break;
+        case 1:
+            sprintf(buffer, "0%lo ", value & 0xFFFF);
+            break;
+        default:
+            sprintf(buffer, "%lu ", value % 1000000);
+            break;
+        }
+        _write(c, buffer);
+    }
+    _write(c, "\n),\n");
+}
+
+/* a string continued on width lines */
+static void _continuations(CORPUS *c, unsigned long n)
+{
+    char buffer[64];
+    unsigned long i;
+
+    sprintf(buffer, "lines%lu\n", n);
+    _write(c, buffer);
+    for (i = 0; i < c->width; i++)
+    {
+        _write(c, i ? " \\\n  \"" : "  \"");
+        _text(c, c->length / c->width + 1);
+        _write(c, "\"");
+    }
+    _write(c, ";\n");
+}
+
+static const CORPUS_RECORD _records[] = {
+    _wide, _deep, _strings, _numbers, _continuations};
+
+static const char *const _kinds[] = {
+    "wide", "deep", "strings", "numbers", "continuations", "mixed"};
+
+static void _mixed(CORPUS *c, unsigned long n)
+{
+    _records[_random(c) % _COUNT(_records)](c, n);
+}
+
+static int _usage(void)
+{
+    fprintf(stderr,
+            "usage: snot_corpus KIND [-s bytes] [-w width] [-d depth] "
+            "[-l length] [-S seed] [-o file]\n"
+            "KIND: wide, deep, strings, numbers, continuations or mixed\n");
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    CORPUS c;
+    CORPUS_RECORD record = NULL;
+    unsigned long n;
+    int i;
+
+    if (argc < 2)
+        return _usage();
+
+    c.out     = stdout;
+    c.size    = 16UL << 20;
+    c.width   = 32;
+    c.depth   = 64;
+    c.length  = 1024;
+    c.seed    = 2463534242UL;
+    c.written = 0;
+
+    for (n = 0; n < _COUNT(_kinds); n++)
+        if (!strcmp(argv[1], _kinds[n]))
+            record = n < _COUNT(_records) ? _records[n] : _mixed;
+    if (!record)
+        return _usage();
+
+    for (i = 2; i + 1 < argc; i += 2)
+    {
+        const unsigned long value = strtoul(argv[i + 1], NULL, 0);
+
+        if (!strcmp(argv[i], "-s"))
+            c.size = value;
+        else if (!strcmp(argv[i], "-w") && value)
+            c.width = value;
+        else if (!strcmp(argv[i], "-d"))
+            c.depth = value;
+        else if (!strcmp(argv[i], "-l") && value)
+            c.length = value;
+        else if (!strcmp(argv[i], "-S") && value)
+            c.seed = value & 0xFFFFFFFFUL;
+        else if (!strcmp(argv[i], "-o"))
+        {
+            c.out = fopen(argv[i + 1], "wb");
+            if (!c.out)
+            {
+                fprintf(stderr, "cannot open %s\n", argv[i + 1]);
+                return 1;
+            }
+        }
+        else
+            return _usage();
+    }
+    if (i < argc)
+        return _usage();
+
+    for (n = 0; c.written < c.size; n++)
+        record(&c, n);
+
+    if (c.out != stdout)
+        fclose(c.out);
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+/*
+ * Runs the switch-based lexer of snot 0.1.0, from reference/snot.h, for
+ * snot_bench. Its functions are static here, so they do not clash with the
+ * library.
+ */
+#define SNOT_STATIC
+#include "reference/snot.h"
+
+#include "reference.h"
+#include "utf8.h"
+
+#include <stdlib.h>
+
+static size_t _reference_allocations = 0;
+
+static void *_reference_alloc(size_t size)
+{
+    _reference_allocations++;
+    return malloc(size);
+}
+
+static void *_reference_grow(void *memory, size_t *size, size_t grow_size)
+{
+    _reference_allocations++;
+    *size += grow_size;
+    return realloc(memory, *size);
+}
+
+static void _reference_event(SNOT_PARSER *p, size_t id, void *userdata)
+{
+    (void)p;
+    (void)id;
+    (*(size_t *)userdata)++;
+}
+
+int snot_reference_parse(const char *utf8,
+                         size_t length,
+                         size_t *parsed,
+                         size_t *events,
+                         size_t *allocations)
+{
+    const unsigned char *s   = (const unsigned char *)utf8;
+    const unsigned char *end = s + length;
+    SNOT_CALLBACKS cx;
+    SNOT_PARSER *p;
+    SNOT_RESULT result = SNOT_OK;
+    uint32_t c;
+
+    cx.alloc         = _reference_alloc;
+    cx.free          = free;
+    cx.grow          = _reference_grow;
+    cx.start_section = _reference_event;
+    cx.end_section   = _reference_event;
+    cx.string        = _reference_event;
+    cx.number        = _reference_event;
+
+    _reference_allocations = 0;
+    p                      = snot_create(cx, events);
+
+    while (s < end && result == SNOT_OK)
+    {
+        s += bench_decode_utf8(s, end - s, &c);
+        result = snot_parse(p, c);
+    }
+    if (result == SNOT_OK)
+        result = snot_end(p);
+
+    snot_free(p);
+    *parsed      = s - (const unsigned char *)utf8;
+    *allocations = _reference_allocations;
+
+    return result == SNOT_OK;
+}
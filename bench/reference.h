@@ -0,0 +1,30 @@
+/*
+ * The lexer of snot 0.1.0, the last one built on switch statements, kept as
+ * the reference snot_bench compares the current lexer with.
+ */
+#ifndef SNOT_BENCH_REFERENCE_H
+#define SNOT_BENCH_REFERENCE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /*
+     * parses length bytes of utf8 one code point at a time, counting the
+     * bytes lexed, the events and the calls to alloc and grow; returns 0 on
+     * errors
+     */
+    int snot_reference_parse(const char *utf8,
+                             size_t length,
+                             size_t *parsed,
+                             size_t *events,
+                             size_t *allocations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
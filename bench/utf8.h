@@ -0,0 +1,42 @@
+/*
+ * The UTF-8 decoding both lexers are fed through when they are compared one
+ * code point at a time, so the loop around them costs the same.
+ */
+#ifndef SNOT_BENCH_UTF8_H
+#define SNOT_BENCH_UTF8_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* decodes the code point at s, U+FFFD for a malformed one, into *c */
+static size_t bench_decode_utf8(const unsigned char *s,
+                                size_t length,
+                                uint32_t *c)
+{
+    size_t count, i;
+
+    if (s[0] < 0x80)
+    {
+        *c = s[0];
+        return 1;
+    }
+
+    if (s[0] >= 0xF0)
+        count = 4, *c = s[0] & 0x07;
+    else if (s[0] >= 0xE0)
+        count = 3, *c = s[0] & 0x0F;
+    else
+        count = 2, *c = s[0] & 0x1F;
+
+    if (count > length)
+    {
+        *c = 0xFFFD;
+        return 1;
+    }
+    for (i = 1; i < count; i++)
+        *c = (*c << 6) | (s[i] & 0x3F);
+
+    return count;
+}
+
+#endif
@@ -8,6 +8,21 @@ void *__grow(void *memory, size_t *size, size_t grow_size)
     return realloc(memory, *size);
 }
 
+void *__shrink(void *memory, size_t *size, size_t shrink_size)
+{
+    void *new_memory;
+    if (shrink_size >= *size)
+    {
+        free(memory);
+        *size = 0;
+        return NULL;
+    }
+    new_memory = realloc(memory, *size - shrink_size);
+    if (new_memory)
+        *size -= shrink_size;
+    return new_memory;
+}
+
 void __start_section_xml(SNOT_PARSER *parser, size_t id, void *userdata)
 {
     const char *name;
@@ -41,12 +56,14 @@ int main(void)
     SNOT_PARSER *parser;
     SNOT_CALLBACKS cx;
     void *userdata = NULL;
-    size_t file_size;
+    size_t length;
+    char buffer[4096];
     const char *filename = "example5.snot";
 
     cx.alloc         = malloc;
     cx.free          = free;
     cx.grow          = __grow;
+    cx.shrink        = __shrink;
     cx.start_section = __start_section_xml;
     cx.end_section   = __end_section_xml;
     cx.string        = __string_xml;
@@ -61,28 +78,16 @@ int main(void)
         return -1;
     }
 
-    fseek(file, 0, SEEK_END);
-    file_size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    while (file_size--)
+    while ((length = fread(buffer, sizeof(char), sizeof(buffer), file)))
     {
-        // ASCII
-        char c;
-        fread(&c, sizeof(char), 1, file);
+        size_t consumed;
 
-        // fill the parser each with character at a time
-        SNOT_RESULT result = snot_parse(parser, c);
-        switch (result)
+        // fill the parser with a whole chunk of UTF-8 at a time
+        SNOT_RESULT result =
+            snot_parse_buffer(parser, buffer, length, &consumed);
+        if (result != SNOT_OK)
         {
-        case SNOT_OK:
-            break;
-        case SNOT_ERROR_NO_MEMORY:
-        case SNOT_ERROR_INVALID_CHARACTER:
-        case SNOT_ERROR_PARTIAL:
-        case SNOT_ERROR_TOKEN_TYPE_UNDEFINED:
-            printf("Error at %c(code: %d)\n", c, result);
-            file_size = 0;
+            printf("Error at %c(code: %d)\n", buffer[consumed], result);
             break;
         }
     }
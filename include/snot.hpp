@@ -24,17 +24,52 @@ SOFTWARE.
 #pragma once
 #include <snot.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <cinttypes>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define SNOT_HAS_STRING_VIEW
+#endif
+
+#if (__cplusplus >= 201703L ||                                                 \
+     (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)) &&                        \
+    defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define SNOT_HAS_PMR
+#endif
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace snot
 {
 
-class value
+/**
+ * @brief Number types and decoding shared by every basic_value
+ */
+class value_base
 {
 public:
     enum type
@@ -45,141 +80,317 @@ public:
         hexadecimal,
     };
 
-    value() : m_type(string), m_value(""){};
-    value(const std::string &value, type type = string)
-        : m_type(type), m_value(value){};
-    value(const char *value, type type = string)
-        : m_type(type), m_value(value){};
+protected:
+    template <
+        typename T,
+        typename = typename std::enable_if<std::is_integral<T>::value, T>::type>
+    static std::string encode(type type, T &d) noexcept
+    {
+        std::ostringstream buffer;
+        switch (type)
+        {
+        case decimal:
+            buffer << std::dec;
+            break;
+        case octal:
+            buffer << std::oct << "0";
+            break;
+        case hexadecimal:
+            buffer << std::hex << "0x";
+            break;
+        default:
+            assert(false && "invalid type " && type);
+            break;
+        }
+        buffer << d;
+        return buffer.str();
+    }
 
-    template <typename T,
-              typename = typename std::enable_if<std::is_arithmetic<T>::value,
-                                                 T>::type>
-    value(T t, type type = decimal) : m_type(type), m_value(encode(type, t))
+    // what the text of a number holds, see parse_number
+    enum number_kind : unsigned char
+    {
+        not_a_number,
+        unsigned_integer,
+        negative_integer,
+        real,
+    };
+
+    union number_value
+    {
+        uint64_t u64;
+        int64_t i64;
+        double f64;
+    };
+
+    static unsigned digit(char c) noexcept
     {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        c |= 0x20;
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return 16;
     }
 
-    operator const std::string &() const { return m_value; }
+    /*
+     * reads decimal text as the parser does and rounds it with the same code,
+     * strtod with the point of the locale only decides the rare ties
+     */
+    static double parse_real(const char *s, size_t length) noexcept
+    {
+        const char *const start = s;
+        const char *const end   = s + length;
+        uint64_t number         = 0;
+        long exponent           = 0;
+        bool negative = false, fraction = false, full = false, inexact = false;
+        double d;
+
+        if (s != end && (*s == '-' || *s == '+'))
+            negative = *s++ == '-';
+
+        // the digits past 64 bits are dropped and counted in the exponent
+        for (unsigned n; s != end; s++)
+        {
+            if (*s == '.' && !fraction)
+            {
+                fraction = true;
+                continue;
+            }
+            if ((n = digit(*s)) >= 10)
+                break;
+            if (!full && number <= (UINT64_MAX - n) / 10)
+            {
+                number = number * 10 + n;
+                exponent -= fraction;
+            }
+            else
+            {
+                full = true;
+                inexact |= n != 0;
+                exponent += !fraction;
+            }
+        }
+
+        if (s != end && (*s | 0x20) == 'e')
+        {
+            bool minus = false;
+            long e     = 0;
+
+            if (++s != end && (*s == '-' || *s == '+'))
+                minus = *s++ == '-';
+            for (; s != end && digit(*s) < 10; s++)
+                if (e < 100000)
+                    e = e * 10 + digit(*s);
+            exponent += minus ? -e : e;
+        }
+        exponent = std::max(-100000L, std::min(exponent, 100000L));
+
+        if (!_snot_round_decimal(number,
+                                 (int)exponent,
+                                 inexact ? SNOT_TRUE : SNOT_FALSE,
+                                 &d))
+            return strtod_c(start, length);
+        return negative ? -d : d;
+    }
 
-    template <
-        typename T,
-        typename U = typename std::enable_if<std::is_floating_point<T>::value ||
-                                                 std::is_integral<T>::value,
-                                             T>::type>
-    explicit operator U() const noexcept
+    // strtod wants a NUL and the decimal point of the locale
+    static double strtod_c(const char *s, size_t length) noexcept
     {
-        return get_value<U>();
+        const char point = *localeconv()->decimal_point;
+        char buffer[128];
+
+        try
+        {
+            std::string text;
+            char *c = buffer;
+
+            if (length >= sizeof(buffer))
+            {
+                text.resize(length);
+                c = &text[0];
+            }
+            for (size_t i = 0; i < length; i++)
+                c[i] = s[i] == '.' ? point : s[i];
+            c[length] = '\0';
+            return std::strtod(c, nullptr);
+        }
+        catch (...)
+        {
+            return 0;
+        }
     }
 
-    constexpr type get_type() const { return m_type; }
+    /*
+     * parses length bytes of s once, so reading the number later costs a
+     * branch: octal and hexadecimal numbers give their bits, saturated to 64,
+     * decimal ones an integer, or a double when they have a fraction, an
+     * exponent or too many digits
+     */
+    static number_kind parse_number(type type,
+                                    const char *s,
+                                    size_t length,
+                                    number_value &n) noexcept
+    {
+        const char *const start = s;
+        const char *const end   = s + length;
+        bool negative           = false;
+        bool overflow           = false;
+        unsigned base;
 
-    template <typename T,
-              typename =
-                  typename std::enable_if<!std::is_integral<T>::value, T>::type>
-    T get_value(float = 0) const noexcept;
+        n.u64 = 0;
+        switch (type)
+        {
+        case octal:
+            base = 8;
+            s += std::min<size_t>(length, 1);
+            break;
+        case hexadecimal:
+            base = 16;
+            s += std::min<size_t>(length, 2);
+            break;
+        case decimal:
+            base = 10;
+            if (s != end && (*s == '-' || *s == '+'))
+                negative = *s++ == '-';
+            break;
+        default:
+            return not_a_number;
+        }
 
-    template <
-        typename T,
-        typename = typename std::enable_if<std::is_integral<T>::value, T>::type>
-    T get_value(int = 0) const noexcept
+        for (unsigned d; s != end && (d = digit(*s)) < base; s++)
+        {
+            if (n.u64 > (UINT64_MAX - d) / base)
+                overflow = true;
+            else
+                n.u64 = n.u64 * base + d;
+        }
+
+        if (base != 10)
+        {
+            if (overflow)
+                n.u64 = UINT64_MAX;
+            return unsigned_integer;
+        }
+        if (overflow || (s != end && (*s == '.' || *s == 'e' || *s == 'E')) ||
+            (negative && (!n.u64 || n.u64 > (uint64_t)INT64_MAX + 1)))
+        {
+            // -0 too, an integer would lose its sign
+            n.f64 = parse_real(start, length);
+            return real;
+        }
+        if (!negative)
+            return unsigned_integer;
+        n.i64 = -(int64_t)(n.u64 - 1) - 1;
+        return negative_integer;
+    }
+
+    // a decimal integer past INT64_MAX saturates, as strtoll does
+    static int64_t
+    to_int64(type type, number_kind kind, number_value n) noexcept
+    {
+        switch (kind)
+        {
+        case unsigned_integer:
+            if (type == decimal && n.u64 > (uint64_t)INT64_MAX)
+                return INT64_MAX;
+            return (int64_t)n.u64;
+        case negative_integer:
+            return n.i64;
+        case real:
+            if (n.f64 != n.f64)
+                return 0;
+            if (n.f64 <= -9223372036854775808.0)
+                return INT64_MIN;
+            if (n.f64 >= 9223372036854775808.0)
+                return INT64_MAX;
+            return (int64_t)n.f64;
+        default:
+            return 0;
+        }
+    }
+
+    // a negative number wraps around, as strtoull does
+    static uint64_t to_uint64(number_kind kind, number_value n) noexcept
     {
-        T d = 0;
-        if (decode(d) == EOF)
+        switch (kind)
+        {
+        case unsigned_integer:
+            return n.u64;
+        case negative_integer:
+            return (uint64_t)n.i64;
+        case real:
+            if (n.f64 != n.f64)
+                return 0;
+            if (n.f64 < 0)
+                return (uint64_t)to_int64(decimal, kind, n);
+            if (n.f64 >= 18446744073709551616.0)
+                return UINT64_MAX;
+            return (uint64_t)n.f64;
+        default:
             return 0;
-        return d;
+        }
+    }
+
+    // the 64 bit integer truncated to T, like the C library reads it
+    template <typename T>
+    static T to_integral(type type, number_kind kind, number_value n) noexcept
+    {
+        return (T)(std::is_signed<T>::value
+                       ? (uint64_t)to_int64(type, kind, n)
+                       : to_uint64(kind, n));
     }
 
 #ifdef __STDC_IEC_559__ // IEEE-754
-    template <> double get_value(float) const noexcept
+    // octal and hexadecimal numbers hold the bits of the real
+    static double to_real(type type, number_kind kind, number_value n, double)
+        noexcept
     {
         union
         {
             double f64;
             uint64_t u64;
         };
-        assert(is_number());
-        switch (m_type)
+        switch (kind)
         {
-        case decimal:
-            if (std::sscanf(m_value.c_str(), "%lf", &f64) == EOF)
-                return 0;
-            return f64;
-        case octal:
-        case hexadecimal:
-            if (decode<uint64_t>(u64) == EOF)
-                return 0;
-            u64 = from_le(u64);
+        case unsigned_integer:
+            if (type == decimal)
+                return (double)n.u64;
+            u64 = from_le(n.u64);
             return f64;
+        case negative_integer:
+            return (double)n.i64;
+        case real:
+            return n.f64;
         default:
-            assert(false && "invalid m_type " && m_type);
             return 0;
         }
     }
 
-    template <> float get_value(float) const noexcept
+    static float to_real(type type, number_kind kind, number_value n, float)
+        noexcept
     {
         union
         {
             float f32;
             uint32_t u32;
         };
-        assert(is_number());
-        switch (m_type)
+        switch (kind)
         {
-        case decimal:
-            if (std::sscanf(m_value.c_str(), "%f", &f32) == EOF)
-                return 0;
-            return f32;
-        case octal:
-        case hexadecimal:
-            if (decode<uint32_t>(u32) == EOF)
-                return 0;
-            u32 = from_le(u32);
+        case unsigned_integer:
+            if (type == decimal)
+                return (float)n.u64;
+            u32 = from_le((uint32_t)n.u64);
             return f32;
+        case negative_integer:
+            return (float)n.i64;
+        case real:
+            return (float)n.f64;
         default:
-            assert(false && "invalid m_type " && m_type);
             return 0;
         }
     }
 #endif
 
-    constexpr bool is_string() const noexcept { return m_type == string; }
-
-    constexpr bool is_number() const noexcept
-    {
-        return m_type == decimal || m_type == octal || m_type == hexadecimal;
-    }
-
-private:
-    template <
-        typename T,
-        typename = typename std::enable_if<std::is_integral<T>::value, T>::type>
-    constexpr int decode(T &d) const noexcept;
-
-    template <
-        typename T,
-        typename = typename std::enable_if<std::is_integral<T>::value, T>::type>
-    static std::string encode(type type, T &d) noexcept
-    {
-        std::ostringstream buffer;
-        switch (type)
-        {
-        case decimal:
-            buffer << std::dec;
-            break;
-        case octal:
-            buffer << std::oct << "0";
-            break;
-        case hexadecimal:
-            buffer << std::hex << "0x";
-            break;
-        default:
-            assert(false && "invalid type " && type);
-            break;
-        }
-        buffer << d;
-        return buffer.str();
-    }
-
     template <
         typename T,
         typename = typename std::enable_if<std::is_unsigned<T>::value, T>::type>
@@ -202,181 +413,151 @@ private:
             *(uint8_t *)&value = (uint8_t)((&n >> (8 * i)) & 0xFF);
         return value;
     }
+};
 
-    template <> int decode(uint64_t &d) const noexcept
+/**
+ * @brief A string or a number, its text allocated with Allocator
+ */
+template <typename Allocator = std::allocator<char>>
+class basic_value : public value_base
+{
+public:
+    using allocator_type = Allocator;
+    using string_type    = std::basic_string<
+        char,
+        std::char_traits<char>,
+        typename std::allocator_traits<Allocator>::template rebind_alloc<char>>;
+
+    basic_value() : m_type(string), m_value(""){};
+    explicit basic_value(const Allocator &alloc)
+        : m_type(string), m_value("", alloc){};
+    basic_value(const std::string &value,
+                type type              = string,
+                const Allocator &alloc = Allocator())
+        : m_type(type), m_value(value.data(), value.size(), alloc)
     {
-        int readed = EOF;
-        switch (m_type)
-        {
-        case decimal:
-            readed = std::sscanf(m_value.c_str(), "%" SCNu64, &d);
-            break;
-        case octal:
-            readed = std::sscanf(m_value.c_str() + 1, "%" SCNo64, &d);
-            break;
-        case hexadecimal:
-            readed = std::sscanf(m_value.c_str() + 2, "%" SCNx64, &d);
-            break;
-        default:
-            assert(false && "invalid m_type " && m_type);
-            break;
-        }
-        return readed;
+        parse();
     }
-
-    template <> int decode(uint32_t &d) const noexcept
+    basic_value(const char *value,
+                type type              = string,
+                const Allocator &alloc = Allocator())
+        : m_type(type), m_value(value, alloc)
     {
-        int readed = EOF;
-        switch (m_type)
-        {
-        case decimal:
-            readed = std::sscanf(m_value.c_str(), "%" SCNu32, &d);
-            break;
-        case octal:
-            readed = std::sscanf(m_value.c_str() + 1, "%" SCNo32, &d);
-            break;
-        case hexadecimal:
-            readed = std::sscanf(m_value.c_str() + 2, "%" SCNx32, &d);
-            break;
-        default:
-            assert(false && "invalid m_type " && m_type);
-            break;
-        }
-        return readed;
+        parse();
     }
-
-    template <> int decode(uint16_t &d) const noexcept
+    basic_value(const char *value,
+                size_t length,
+                type type,
+                const Allocator &alloc = Allocator())
+        : m_type(type), m_value(value, length, alloc)
     {
-        int readed = EOF;
-        switch (m_type)
-        {
-        case decimal:
-            readed = std::sscanf(m_value.c_str(), "%" SCNu16, &d);
-            break;
-        case octal:
-            readed = std::sscanf(m_value.c_str() + 1, "%" SCNo16, &d);
-            break;
-        case hexadecimal:
-            readed = std::sscanf(m_value.c_str() + 2, "%" SCNx16, &d);
-        default:
-            assert(false && "invalid m_type " && m_type);
-            break;
-        }
-        return readed;
+        parse();
     }
 
-    template <> int decode(uint8_t &d) const noexcept
+    template <typename T,
+              typename = typename std::enable_if<std::is_arithmetic<T>::value,
+                                                 T>::type>
+    basic_value(T t, type type = decimal, const Allocator &alloc = Allocator())
+        : m_type(type), m_value(encode(type, t).c_str(), alloc)
     {
-        int readed = EOF;
-        switch (m_type)
-        {
-        case decimal:
-            readed = std::sscanf(m_value.c_str(), "%" SCNu8, &d);
-            break;
-        case octal:
-            readed = std::sscanf(m_value.c_str() + 1, "%" SCNo8, &d);
-            break;
-        case hexadecimal:
-            readed = std::sscanf(m_value.c_str() + 2, "%" SCNx8, &d);
-            break;
-        default:
-            assert(false && "invalid m_type " && m_type);
-            break;
-        }
-        return readed;
+        parse();
     }
 
-    template <> int decode(int64_t &d) const noexcept
+    // copies that keep to the allocator of the container they go in
+    basic_value(const basic_value &other) = default;
+    basic_value(basic_value &&other)      = default;
+    basic_value(const basic_value &other, const Allocator &alloc)
+        : m_type(other.m_type), m_kind(other.m_kind), m_number(other.m_number),
+          m_value(other.m_value, alloc)
     {
-        int readed  = EOF;
-        uint64_t d2 = 0;
-        switch (m_type)
-        {
-        case decimal:
-            readed = std::sscanf(m_value.c_str(), "%" SCNi64, &d);
-            break;
-        case octal:
-        case hexadecimal:
-            readed = decode(d2);
-            d      = *(int64_t *)&d2;
-            break;
-        default:
-            assert(false && "invalid m_type " && m_type);
-            break;
-        }
-        return readed;
     }
-
-    template <> int decode(int32_t &d) const noexcept
+    basic_value(basic_value &&other, const Allocator &alloc)
+        : m_type(other.m_type), m_kind(other.m_kind), m_number(other.m_number),
+          m_value(std::move(other.m_value), alloc)
     {
-        int readed  = EOF;
-        uint32_t d2 = 0;
-        switch (m_type)
-        {
-        case decimal:
-            readed = std::sscanf(m_value.c_str(), "%" SCNi32, &d);
-            break;
-        case octal:
-        case hexadecimal:
-            readed = decode(d2);
-            d      = *(int32_t *)&d2;
-            break;
-        default:
-            assert(false && "invalid m_type " && m_type);
-            break;
-        }
-        return readed;
     }
+    basic_value &operator=(const basic_value &other) = default;
+    basic_value &operator=(basic_value &&other)      = default;
 
-    template <> int decode(int16_t &d) const noexcept
+    operator const string_type &() const { return m_value; }
+
+    template <
+        typename T,
+        typename U = typename std::enable_if<std::is_floating_point<T>::value ||
+                                                 std::is_integral<T>::value,
+                                             T>::type>
+    explicit operator U() const noexcept
     {
-        int readed  = EOF;
-        uint16_t d2 = 0;
-        switch (m_type)
-        {
-        case decimal:
-            readed = std::sscanf(m_value.c_str(), "%" SCNi16, &d);
-            break;
-        case octal:
-        case hexadecimal:
-            readed = decode(d2);
-            d      = *(int16_t *)&d2;
-            break;
-        default:
-            assert(false && "invalid m_type " && m_type);
-            break;
-        }
-        return readed;
+        return get_value<U>();
     }
 
-    template <> int decode(int8_t &d) const noexcept
+    constexpr type get_type() const { return m_type; }
+
+    template <typename T,
+              typename =
+                  typename std::enable_if<!std::is_integral<T>::value, T>::type>
+    T get_value(float = 0) const noexcept
     {
-        int readed  = EOF;
-        uint64_t d2 = 0;
-        switch (m_type)
-        {
-        case decimal:
-            readed = std::sscanf(m_value.c_str(), "%" SCNi8, &d);
-            break;
-        case octal:
-        case hexadecimal:
-            readed = decode(d2);
-            d      = *(int8_t *)&d2;
-            break;
-        default:
-            assert(false && "invalid m_type " && m_type);
-            break;
-        }
-        return readed;
+        assert(is_number());
+        return to_real(m_type, m_kind, m_number, T());
+    }
+
+    template <
+        typename T,
+        typename = typename std::enable_if<std::is_integral<T>::value, T>::type>
+    T get_value(int = 0) const noexcept
+    {
+        return to_integral<T>(m_type, m_kind, m_number);
+    }
+
+    constexpr bool is_string() const noexcept { return m_type == string; }
+
+    constexpr bool is_number() const noexcept
+    {
+        return m_type == decimal || m_type == octal || m_type == hexadecimal;
     }
 
+private:
     type m_type;
-    std::string m_value;
+    number_kind m_kind    = not_a_number;
+    number_value m_number = {0}; // parsed when the value is made
+    string_type m_value;
+
+    void parse()
+    {
+        m_kind = parse_number(m_type, m_value.data(), m_value.size(), m_number);
+    }
 };
 
-class node
+using value = basic_value<>;
+
+/**
+ * @brief A section with its content and children, all allocated with
+ * Allocator
+ *
+ * Children are freed with the allocator of their parent, nodes added by hand
+ * should come from basic_node::make.
+ */
+template <typename Allocator = std::allocator<char>> class basic_node
 {
+    template <typename T>
+    using rebind =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
 public:
+    using allocator_type = Allocator;
+    using value          = basic_value<Allocator>;
+    using string_type    = typename value::string_type;
+    using content_type   = std::vector<value, rebind<value>>;
+#ifdef SNOT_HAS_STRING_VIEW
+    using name_view = std::string_view;
+#else
+    using name_view = const std::string &;
+#endif
+
+    // a node with this many children indexes them all by name
+    static const size_t index_threshold = 32;
+
     template <typename T> struct node_iterator
     {
         using iterator_category = std::forward_iterator_tag;
@@ -417,21 +598,345 @@ public:
     private:
         pointer m_ptr;
     };
-    using iterator       = node_iterator<node>;
-    using const_iterator = node_iterator<const node>;
+    using iterator       = node_iterator<basic_node>;
+    using const_iterator = node_iterator<const basic_node>;
+
+    basic_node()
+        : m_parent(nullptr), m_children(nullptr), m_next(nullptr), m_lineNo(-1),
+          m_index(nullptr)
+    {
+    }
+
+    explicit basic_node(const Allocator &alloc)
+        : m_name(alloc), m_content(alloc), m_parent(nullptr),
+          m_children(nullptr), m_next(nullptr), m_lineNo(-1), m_index(nullptr)
+    {
+    }
+
+    basic_node(basic_node *parent,
+               const std::string &name,
+               std::initializer_list<value> content = {},
+               basic_node *next                     = nullptr,
+               size_t lineNo                        = -1,
+               const Allocator &alloc               = Allocator())
+        : m_name(name.data(), name.size(), alloc), m_content(content, alloc),
+          m_parent(parent), m_children(nullptr), m_next(next),
+          m_lineNo(lineNo), m_index(nullptr)
+    {
+        link();
+    }
+
+    // a child of parent named by length bytes of name, as the parser adds it
+    basic_node(basic_node *parent,
+               const char *name,
+               size_t length,
+               size_t lineNo,
+               const Allocator &alloc)
+        : m_name(name, length, alloc), m_content(alloc), m_parent(parent),
+          m_children(nullptr), m_next(nullptr), m_lineNo(lineNo),
+          m_index(nullptr)
+    {
+        link();
+    }
+
+    basic_node(const basic_node &node)
+        : m_name(node.get_allocator()), m_content(node.get_allocator()),
+          m_parent(nullptr), m_next(nullptr), m_lineNo(node.m_lineNo),
+          m_index(nullptr)
+    {
+        copy(node);
+    }
+
+    basic_node(const basic_node &node, const Allocator &alloc)
+        : m_name(alloc), m_content(alloc), m_parent(nullptr), m_next(nullptr),
+          m_lineNo(node.m_lineNo), m_index(nullptr)
+    {
+        copy(node);
+    }
+
+    ~basic_node() { free(); }
+
+    basic_node &operator=(const basic_node &node)
+    {
+        if (&node != this)
+        {
+            free();
+            copy(node);
+        }
+        return *this;
+    }
+
+    // creation methods
+    basic_node(const std::string &name,
+               std::initializer_list<value> content = {},
+               int lineNo                           = -1,
+               const Allocator &alloc               = Allocator())
+        : m_name(name.data(), name.size(), alloc), m_content(content, alloc),
+          m_parent(nullptr), m_children(nullptr), m_last_children(nullptr),
+          m_next(nullptr), m_lineNo(lineNo), m_index(nullptr)
+    {
+    }
+
+    /**
+     * @brief Allocates a node with alloc and constructs it from args
+     */
+    template <typename... Args>
+    static basic_node *make(const Allocator &alloc, Args &&...args)
+    {
+        node_allocator a(alloc);
+        basic_node *const n = node_traits::allocate(a, 1);
+
+        try
+        {
+            // not node_traits::construct, a scoped allocator would pass
+            // alloc a second time
+            ::new ((void *)n) basic_node(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            node_traits::deallocate(a, n, 1);
+            throw;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Destroys a node made by make and frees it
+     */
+    static void destroy(basic_node *n)
+    {
+        node_allocator a(n->get_allocator());
+
+        node_traits::destroy(a, n);
+        node_traits::deallocate(a, n, 1);
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(m_name.get_allocator());
+    }
+
+    void add_child(basic_node &child)
+    {
+        if (m_children == nullptr)
+        {
+            m_children      = &child;
+            m_last_children = &child;
+        }
+        else
+        {
+            m_last_children->m_next = &child;
+            m_last_children         = &child;
+        }
+        child.m_next   = nullptr;
+        child.m_parent = this;
+        m_child_count++;
+        index_insert(child);
+    }
+
+    bool insert_child(basic_node &child, basic_node &following_node)
+    {
+        if (following_node.m_parent != this)
+            return false;
+
+        if (m_children == &following_node)
+        {
+            child.m_next = m_children;
+            m_children   = &child;
+        }
+        else
+        {
+            basic_node *ch = m_children;
+            while (ch && ch->m_next != &following_node)
+                ch = ch->m_next;
+            if (!ch)
+                return false;
+            child.m_next = &following_node;
+            ch->m_next   = &child;
+        }
+        child.m_parent = this;
+        m_child_count++;
+        index_insert(child);
+        return true;
+    }
+
+    bool insert_child_after(basic_node &child, basic_node &preceding_node)
+    {
+        if (preceding_node.m_parent != this)
+            return false;
 
-    node()
-        : m_parent(nullptr), m_children(nullptr), m_next(nullptr), m_lineNo(-1)
+        child.m_next          = preceding_node.m_next;
+        preceding_node.m_next = &child;
+        child.m_parent        = this;
+        if (&preceding_node == m_last_children)
+            m_last_children = &child;
+        m_child_count++;
+        index_insert(child);
+        return true;
+    }
+
+    bool remove_child(basic_node &child)
+    {
+        if (child.m_parent != this)
+            return false;
+        if (m_children == &child)
+        {
+            if (m_children != m_last_children)
+                m_children = child.m_next;
+            else
+                m_last_children = m_children = nullptr;
+            goto remove;
+        }
+        {
+            basic_node *ch = m_children;
+            while (ch->m_next)
+            {
+                if (ch->m_next == &child)
+                {
+                    ch->m_next = child.m_next;
+                    if (&child == m_last_children)
+                        m_last_children = ch;
+                    goto remove;
+                }
+                ch = ch->m_next;
+            }
+        }
+        return false;
+    remove:
+        index_erase(child);
+        m_child_count--;
+        child.m_parent = nullptr;
+        child.m_next   = nullptr;
+        return true;
+    }
+
+    // access methods
+    const string_type &name() const { return m_name; }
+
+    /**
+     * @brief Renames the node, keeping the index of its parent up to date
+     */
+    void set_name(name_view node_name)
+    {
+        string_type n(node_name.data(), node_name.size(), get_allocator());
+        replace_name(n);
+    }
+
+    content_type &content() { return m_content; }
+    const content_type &content() const { return m_content; }
+
+    basic_node *&parent() { return m_parent; }
+    const basic_node *parent() const { return m_parent; }
+
+    int depth(basic_node *grand_parent = nullptr) const
+    {
+        const basic_node *n = this;
+        int ret             = -1;
+        do
+        {
+            ret++;
+            n = n->parent();
+            if (n == grand_parent)
+                return ret;
+        } while (n);
+        return EOF;
+    }
+
+    iterator begin() { return iterator(m_children); }
+    iterator end() { return iterator(nullptr); }
+
+    const_iterator begin() const { return const_iterator(m_children); }
+    const_iterator end() const { return const_iterator(nullptr); }
+
+    const_iterator cbegin() const { return const_iterator(m_children); }
+    const_iterator cend() const { return const_iterator(nullptr); }
+
+    /**
+     * @brief Finds the first child named node_name
+     *
+     * A node with index_threshold children or more keeps them indexed by
+     * name, so lookups take constant time however wide it is. Lookups only
+     * read the node, and may run concurrently on a const one.
+     */
+    bool at(name_view node_name, iterator *value)
+    {
+        basic_node *const n = find(node_name.data(), node_name.size());
+
+        if (n && value)
+            *value = iterator(n);
+        return n != nullptr;
+    }
+
+    bool at(name_view node_name, const_iterator *value) const
+    {
+        const basic_node *const n = find(node_name.data(), node_name.size());
+
+        if (n && value)
+            *value = const_iterator(n);
+        return n != nullptr;
+    }
+
+    iterator at(name_view node_name) noexcept
+    {
+        iterator it = end();
+        at(node_name, &it);
+        return it;
+    }
+
+    const_iterator at(name_view node_name) const noexcept
+    {
+        const_iterator it = end();
+        at(node_name, &it);
+        return it;
+    }
+
+    bool has(name_view node_name) const noexcept
+    {
+        return at(node_name, nullptr);
+    }
+
+    iterator operator[](name_view node_name) { return at(node_name); }
+    const_iterator operator[](name_view node_name) const
     {
+        return at(node_name);
     }
 
-    node(node *parent,
-         const std::string &name,
-         std::initializer_list<value> content = {},
-         node *next                           = nullptr,
-         size_t lineNo                        = -1)
-        : m_name(name), m_content(content), m_parent(parent),
-          m_children(nullptr), m_next(next), m_lineNo(lineNo)
+    int lineNo() const { return m_lineNo; }
+
+private:
+    using node_allocator = rebind<basic_node>;
+    using node_traits    = std::allocator_traits<node_allocator>;
+
+    string_type m_name;
+    content_type m_content;
+
+    // the first child of each name, in open addressing at most half full
+    struct index_slot
+    {
+        basic_node *node;
+        uint32_t hash;
+    };
+
+    struct child_index
+    {
+        explicit child_index(const Allocator &alloc) : slots(alloc), count(0)
+        {
+        }
+
+        std::vector<index_slot, rebind<index_slot>> slots;
+        size_t count;
+    };
+
+    using index_allocator = rebind<child_index>;
+    using index_traits    = std::allocator_traits<index_allocator>;
+
+    basic_node *m_parent, *m_children, *m_last_children, *m_next;
+    size_t m_lineNo;
+    size_t m_child_count = 0;
+    child_index *m_index;
+
+    // appends this node to the children of m_parent
+    void link()
     {
         if (m_parent)
         {
@@ -446,133 +951,1471 @@ public:
                 m_parent->m_children      = this;
                 m_parent->m_last_children = this;
             }
+            m_parent->m_child_count++;
+            m_parent->index_insert(*this);
         }
     }
 
-    node(const node &node)
-        : m_parent(nullptr), m_next(nullptr), m_lineNo(node.m_lineNo)
+    bool is_named(const char *name, size_t length) const
+    {
+        return m_name.size() == length &&
+               std::char_traits<char>::compare(m_name.data(), name, length) ==
+                   0;
+    }
+
+    basic_node *find(const char *name, size_t length) const
+    {
+        if (m_index)
+            return index_find(name, length, _snot_hash(name, length))->node;
+
+        for (basic_node *c = m_children; c; c = c->m_next)
+            if (c->is_named(name, length))
+                return c;
+        return nullptr;
+    }
+
+    // swaps in a name made with the node's allocator
+    void replace_name(string_type &name)
+    {
+        if (m_parent)
+            m_parent->index_erase(*this);
+        m_name.swap(name);
+        if (m_parent)
+            m_parent->index_insert(*this);
+    }
+
+    // the slot of the child named name, or the empty slot where it goes
+    index_slot *index_find(const char *name, size_t length, uint32_t hash) const
+    {
+        const size_t mask = m_index->slots.size() - 1;
+        size_t slot;
+
+        for (slot = hash & mask; m_index->slots[slot].node;
+             slot = (slot + 1) & mask)
+        {
+            const index_slot &s = m_index->slots[slot];
+            if (s.hash == hash && s.node->is_named(name, length))
+                break;
+        }
+        return &m_index->slots[slot];
+    }
+
+    void index_rehash(size_t slot_count)
+    {
+        std::vector<index_slot, rebind<index_slot>> slots(
+            slot_count, index_slot{nullptr, 0}, get_allocator());
+        const size_t mask = slot_count - 1;
+
+        for (const index_slot &s : m_index->slots)
+        {
+            if (!s.node)
+                continue;
+            size_t slot = s.hash & mask;
+            while (slots[slot].node)
+                slot = (slot + 1) & mask;
+            slots[slot] = s;
+        }
+        m_index->slots.swap(slots);
+    }
+
+    // without memory for it, lookups keep walking the children
+    void index_build()
+    {
+        index_allocator a(get_allocator());
+        size_t slot_count = 64;
+
+        while (slot_count < m_child_count * 2)
+            slot_count *= 2;
+
+        try
+        {
+            child_index *const index = index_traits::allocate(a, 1);
+            ::new ((void *)index) child_index(get_allocator());
+            m_index = index;
+            index_rehash(slot_count);
+        }
+        catch (...)
+        {
+            index_drop();
+            return;
+        }
+
+        for (basic_node *c = m_children; c; c = c->m_next)
+        {
+            const char *name    = c->m_name.data();
+            const size_t length = c->m_name.size();
+            const uint32_t hash = _snot_hash(name, length);
+            index_slot *s       = index_find(name, length, hash);
+
+            if (!s->node)
+            {
+                s->node = c;
+                s->hash = hash;
+                m_index->count++;
+            }
+        }
+    }
+
+    // records child, just linked in, unless a child before it has its name
+    void index_insert(basic_node &child)
+    {
+        if (!m_index)
+        {
+            // the children are indexed with the one that reaches the threshold
+            if (m_child_count >= index_threshold)
+                index_build();
+            return;
+        }
+        if ((m_index->count + 1) * 2 > m_index->slots.size())
+        {
+            try
+            {
+                index_rehash(m_index->slots.size() * 2);
+            }
+            catch (...)
+            {
+                index_drop();
+                return;
+            }
+        }
+
+        const char *name    = child.m_name.data();
+        const size_t length = child.m_name.size();
+        const uint32_t hash = _snot_hash(name, length);
+        index_slot *s       = index_find(name, length, hash);
+
+        if (!s->node)
+        {
+            s->node = &child;
+            s->hash = hash;
+            m_index->count++;
+            return;
+        }
+        for (basic_node *c = child.m_next; c; c = c->m_next)
+        {
+            if (c == s->node)
+            {
+                s->node = &child;
+                return;
+            }
+        }
+    }
+
+    // forgets child, about to be unlinked, for the next child of its name
+    void index_erase(basic_node &child)
+    {
+        if (!m_index)
+            return;
+
+        const char *name    = child.m_name.data();
+        const size_t length = child.m_name.size();
+        const uint32_t hash = _snot_hash(name, length);
+        index_slot *s       = index_find(name, length, hash);
+
+        if (s->node != &child)
+            return;
+        for (basic_node *c = child.m_next; c; c = c->m_next)
+        {
+            if (c->is_named(name, length))
+            {
+                s->node = c;
+                return;
+            }
+        }
+
+        // shifts back the slots that probed past this one
+        const size_t mask = m_index->slots.size() - 1;
+        size_t hole       = s - m_index->slots.data();
+        size_t slot       = hole;
+
+        while (m_index->slots[slot = (slot + 1) & mask].node)
+        {
+            const size_t home = m_index->slots[slot].hash & mask;
+            if (((slot - home) & mask) >= ((slot - hole) & mask))
+            {
+                m_index->slots[hole] = m_index->slots[slot];
+                hole                 = slot;
+            }
+        }
+        m_index->slots[hole].node = nullptr;
+        m_index->count--;
+    }
+
+    void index_drop()
+    {
+        if (m_index)
+        {
+            index_allocator a(get_allocator());
+
+            index_traits::destroy(a, m_index);
+            index_traits::deallocate(a, m_index, 1);
+            m_index = nullptr;
+        }
+    }
+
+    void free()
+    {
+        basic_node *c, *c2;
+        index_drop();
+        for (c = m_children; c; c = c2)
+        {
+            c2 = c->m_next;
+            destroy(c);
+        }
+    }
+
+    void copy(const basic_node &n)
+    {
+        string_type name(n.m_name.data(), n.m_name.size(), get_allocator());
+
+        replace_name(name);
+        m_content.clear();
+        m_content.reserve(n.m_content.size());
+        for (const value &v : n.m_content)
+            m_content.push_back(value(v, get_allocator()));
+        m_lineNo        = n.m_lineNo;
+        m_children      = nullptr;
+        m_last_children = nullptr;
+        m_child_count   = 0;
+
+        for (auto &c : n)
+            add_child(*make(get_allocator(), c, get_allocator()));
+    }
+};
+
+using node = basic_node<>;
+
+/**
+ * @brief Thread-safe pool of parsers
+ *
+ * Released parsers are reset and kept with their token stack and string
+ * pool, so parsing many small documents reuses the same buffers instead of
+ * allocating new ones each time.
+ */
+class parser_pool
+{
+public:
+    /**
+     * @brief Parser borrowed from a pool, returned to it on destruction
+     */
+    class lease
+    {
+    public:
+        lease(parser_pool *pool, SNOT_PARSER *parser)
+            : m_pool(pool), m_parser(parser)
+        {
+        }
+        lease(lease &&other) noexcept
+            : m_pool(other.m_pool), m_parser(other.m_parser)
+        {
+            other.m_parser = nullptr;
+        }
+        lease(const lease &)            = delete;
+        lease &operator=(const lease &) = delete;
+        ~lease()
+        {
+            if (m_parser)
+                m_pool->release(m_parser);
+        }
+
+        SNOT_PARSER *get() const { return m_parser; }
+        operator SNOT_PARSER *() const { return m_parser; }
+        explicit operator bool() const { return m_parser != nullptr; }
+
+    private:
+        parser_pool *m_pool;
+        SNOT_PARSER *m_parser;
+    };
+
+    /**
+     * @brief Creates an empty pool
+     *
+     * @param callbacks Callbacks of every parser in the pool
+     * @param max_idle Released parsers above this count are freed
+     */
+    explicit parser_pool(const SNOT_CALLBACKS &callbacks, size_t max_idle = 16)
+        : m_callbacks(callbacks), m_max_idle(max_idle)
+    {
+        m_idle.reserve(max_idle);
+    }
+
+    parser_pool(const parser_pool &)            = delete;
+    parser_pool &operator=(const parser_pool &) = delete;
+
+    ~parser_pool()
+    {
+        for (SNOT_PARSER *parser : m_idle)
+            snot_free(parser);
+    }
+
+    /**
+     * @brief Borrows a reset parser, creating one if none is idle
+     *
+     * @param userdata Passed to the callbacks while the lease is held
+     */
+    lease acquire(void *userdata = nullptr)
+    {
+        SNOT_PARSER *parser = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_idle.empty())
+            {
+                parser = m_idle.back();
+                m_idle.pop_back();
+            }
+        }
+
+        if (parser)
+            snot_set_userdata(parser, userdata);
+        else
+            parser = snot_create(m_callbacks, userdata);
+
+        return lease(this, parser);
+    }
+
+    /**
+     * @brief Number of parsers waiting to be reused
+     */
+    size_t idle() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_idle.size();
+    }
+
+private:
+    SNOT_CALLBACKS m_callbacks;
+    size_t m_max_idle;
+    mutable std::mutex m_mutex;
+    std::vector<SNOT_PARSER *> m_idle;
+
+    void release(SNOT_PARSER *parser)
+    {
+        snot_reset(parser);
+        snot_set_userdata(parser, nullptr);
+        snot_set_zero_copy(parser, SNOT_FALSE);
+        snot_set_limits(parser, nullptr);
+        snot_set_symbols(parser, SNOT_FALSE);
+        snot_set_batch(parser, nullptr, 0);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_idle.size() < m_max_idle)
+            {
+                m_idle.push_back(parser);
+                return;
+            }
+        }
+        snot_free(parser);
+    }
+};
+
+/**
+ * @brief Outcome of loading a document, converts to true on success
+ *
+ * On failure, code is the first error and offset, line and column tell where
+ * it happened, as snot_position does. A file that can not be opened fails
+ * with SNOT_NEED_INPUT and line 0.
+ */
+struct parse_result
+{
+    SNOT_RESULT code = SNOT_OK;
+    size_t offset    = 0;
+    size_t line      = 0;
+    size_t column    = 0;
+
+    explicit operator bool() const { return code == SNOT_OK; }
+
+    /**
+     * @brief Description of the error code
+     */
+    const char *message() const { return snot_result_string(code); }
+};
+
+struct loaded_document;
+
+/**
+ * @brief A SNOT tree whose nodes, names, contents and values are all
+ * allocated with Allocator
+ */
+template <typename Allocator = std::allocator<char>> class basic_document
+{
+public:
+    using allocator_type = Allocator;
+    using node           = basic_node<Allocator>;
+    using value          = basic_value<Allocator>;
+
+    /**
+     * @brief Default constructor
+     */
+    basic_document() : m_root(nullptr) {}
+
+    /**
+     * @brief Creates an empty document that allocates with alloc
+     */
+    explicit basic_document(const Allocator &alloc)
+        : m_alloc(alloc), m_root(nullptr)
+    {
+    }
+
+    /**
+     * @brief Loads the given filename
+     */
+    basic_document(const std::string &filename) : m_root(nullptr)
+    {
+        load_file(filename);
+    }
+
+    /**
+     * @brief Loads the given SNOT document from given stream.
+     */
+    basic_document(std::basic_istream<char> &stream) : m_root(nullptr)
+    {
+        load_stream(stream);
+    }
+
+    /**
+     * @brief Copy costructor
+     *
+     * Deep copies all the SNOT tree of the given document
+     */
+    basic_document(const basic_document &doc)
+        : m_alloc(doc.m_alloc), m_root(nullptr)
+    {
+        copy(doc);
+    }
+
+    /**
+     * @brief Frees the document root node
+     */
+    ~basic_document() { clear(); }
+
+    /**
+     * @brief Deep copies the document
+     */
+    basic_document &operator=(const basic_document &doc)
+    {
+        if (&doc != this)
+        {
+            clear();
+            copy(doc);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Frees the tree, the document is no longer ok
+     */
+    void clear()
+    {
+        if (m_root)
+            node::destroy(m_root);
+        m_root = nullptr;
+    }
+
+    allocator_type get_allocator() const { return m_alloc; }
+
+    /**
+     * @brief Parses filename as an SNOT document file and loads its data
+     *
+     * On POSIX systems regular files are mapped into memory and parsed in
+     * place, other files are read in large chunks.
+     *
+     * @param filename Filename for SNOT document
+     * @return Returns where the first error happened, if any
+     */
+    parse_result load_file(const std::string &filename,
+                           bool ignore_fail = false)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        return load_mapped(
+            filename,
+            [this, ignore_fail](const char *data, size_t length) {
+                return load_buffer(data, length, ignore_fail);
+            },
+            ignore_fail);
+#else
+        std::ifstream file;
+        file.open(filename, std::ios::binary);
+        if (!file)
+        {
+            parse_result result;
+            result.code = SNOT_NEED_INPUT;
+            return result;
+        }
+        return load_stream(file, ignore_fail);
+#endif
+    }
+
+    /**
+     * @brief Parses the contents as SNOT document and loads its data
+     *
+     * @param contents String that contains a SNOT document data
+     * @return Returns where the first error happened, if any
+     */
+    parse_result load_string(const char *contents, bool ignore_fail = false)
+    {
+        return load_buffer(contents, strlen(contents), ignore_fail);
+    }
+
+    /**
+     * @brief Parses the contents as SNOT document and loads its data
+     *
+     * @param contents String that contains a SNOT document data
+     * @return Returns where the first error happened, if any
+     */
+    parse_result load_string(const std::string &contents,
+                             bool ignore_fail = false)
+    {
+        return load_buffer(contents.data(), contents.size(), ignore_fail);
+    }
+
+    /**
+     * @brief Parses length bytes of data as a SNOT document and loads its data
+     *
+     * @param data Buffer that holds a whole SNOT document
+     * @param length Bytes in data
+     * @return Returns where the first error happened, if any
+     */
+    parse_result
+    load_buffer(const char *data, size_t length, bool ignore_fail = false)
+    {
+        parser_pool::lease parser = parsers().acquire();
+        return load_buffer(parser, data, length, ignore_fail);
+    }
+
+    /**
+     * @brief Parses the data of a given stream as a SNOT document and loads its
+     * data
+     *
+     * @param stream Stream that contains a SNOT document data
+     * @return Returns where the first error happened, if any
+     */
+    parse_result load_stream(std::basic_istream<char> &stream,
+                             bool ignore_fail = false)
+    {
+        std::streambuf *const buffer = stream.rdbuf();
+
+        // whole blocks from the stream buffer, sets eofbit once it is drained
+        return load_chunks(
+            [&stream, buffer](char *data, size_t size) -> long {
+                const std::streamsize n =
+                    buffer ? buffer->sgetn(data, (std::streamsize)size) : 0;
+                if (!n)
+                    stream.setstate(std::ios::eofbit);
+                return (long)n;
+            },
+            ignore_fail);
+    }
+
+    /**
+     * @brief Parses filename as load_file does, on several threads
+     *
+     * The parts of the file that start at the top level of the document are
+     * parsed ahead on other threads, see snot_parse_parallel. Documents
+     * nested under a single section are parsed on one thread.
+     *
+     * @param filename Filename for SNOT document
+     * @param threads Number of threads, 0 for one per core
+     * @return Returns where the first error happened, if any
+     */
+    parse_result load_file_parallel(const std::string &filename,
+                                    unsigned threads = 0,
+                                    bool ignore_fail = false)
+    {
+        if (!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+#if defined(__unix__) || defined(__APPLE__)
+        // pipes and other special files are read in sequence
+        return load_mapped(
+            filename,
+            [this, threads, ignore_fail](const char *data, size_t length) {
+                return load_parallel(data, length, threads, ignore_fail);
+            },
+            ignore_fail);
+#else
+        std::string contents;
+        if (!read_file(filename, contents))
+        {
+            parse_result result;
+            result.code = SNOT_NEED_INPUT;
+            return result;
+        }
+        return load_parallel(
+            contents.data(), contents.size(), threads, ignore_fail);
+#endif
+    }
+
+    /**
+     * @brief Parsers reused by every load, see parser_pool
+     */
+    static parser_pool &parsers()
+    {
+        static parser_pool pool(callbacks());
+        return pool;
+    }
+
+    /**
+     * @brief Saves a SNOT document to a file
+     *
+     * @param filename Filename to save
+     * @param indented if enabled, the file will be indented
+     * @return Returns true if successful, otherwise false
+     */
+    bool save_file(const std::string &filename, bool indented = false)
+    {
+        std::ofstream file;
+        file.open(filename);
+        return save_stream(file, indented);
+    }
+
+    /**
+     * @brief Saves a SNOT document to a stream
+     *
+     * @param stream Stream to save
+     * @param indented if enabled, the file will be indented
+     * @return Returns true if successful, otherwise false
+     */
+    bool save_stream(std::basic_ostream<char> &stream, bool indented = false)
+    {
+        if (!ok())
+            return false;
+
+        const node &n = *m_root;
+        serialize_node(stream, indented, 0, n, false, false);
+        return true;
+    }
+
+    /**
+     * @brief Gets reference to root node pointer
+     */
+    node *&root() { return m_root; }
+
+    /**
+     * @brief Gets root node pointer
+     */
+    node *root() const { return m_root; }
+
+    /**
+     * @brief Checks if document has been loaded succesfully
+     *
+     * @return Returns true if successful, otherwise false
+     */
+    bool ok() const { return root() != nullptr; }
+
+protected:
+    // forgets the tree without freeing it, for allocators that free in bulk
+    void abandon() { m_root = nullptr; }
+
+private:
+    Allocator m_alloc;
+    node *m_root;
+
+    static bool serialize_value(std::basic_ostream<char> &stream,
+                                bool indented,
+                                const typename node::string_type &str,
+                                bool need_separator)
+    {
+        const bool has_space =
+            str.find_first_of(" ,;.()\\") != str.npos;
+        if (has_space)
+        {
+            if (indented)
+                stream << " ";
+            stream << "\"" << str << "\"";
+            need_separator = false;
+        }
+        else
+        {
+            if (need_separator)
+                stream << " ";
+            stream << str;
+            need_separator = true;
+        }
+        return need_separator;
+    }
+
+    static bool serialize_content(std::basic_ostream<char> &stream,
+                                  bool indented,
+                                  const node &n,
+                                  bool need_separator)
+    {
+        bool first = true;
+        for (auto const &f : n.content())
+        {
+            if (first)
+                first = false;
+            else
+            {
+                stream << ",";
+                need_separator = false;
+            }
+
+            need_separator =
+                serialize_value(stream, indented, f, need_separator);
+        }
+        return need_separator;
+    }
+
+    static int serialize_node(std::basic_ostream<char> &stream,
+                              bool indented,
+                              int ident_level,
+                              const node &n,
+                              bool need_separator,
+                              bool show_name = true)
+    {
+        int depth = 0;
+        const std::string sp(ident_level, ' ');
+
+        if (indented)
+        {
+            stream << sp;
+            need_separator = false;
+        }
+
+        if (show_name)
+        {
+            if (indented)
+                ident_level += 2;
+            need_separator =
+                serialize_value(stream, indented, n.name(), need_separator);
+            depth++;
+        }
+
+        if (n.begin() != n.end() && indented) // multiple lines
+        {
+            if (show_name)
+                stream << "\n";
+            if (!n.content().empty() && indented)
+                stream << sp << "  ";
+        }
+
+        need_separator = serialize_content(stream, indented, n, need_separator);
+        if (!n.content().empty())
+            depth++;
+
+        if (n.begin() != n.end())
+        {
+            if (!n.content().empty())
+            {
+                stream << ",";
+                depth--;
+                if (indented)
+                    stream << "\n";
+            }
+
+            int i_depth = 0;
+            for (auto const &c : n)
+            {
+                while (i_depth)
+                {
+                    switch (i_depth)
+                    {
+                    case 1:
+                        i_depth -= 1;
+                        stream << ",";
+                        need_separator = false;
+                        break;
+                    case 2:
+                        i_depth -= 2;
+                        stream << ";";
+                        need_separator = false;
+                        break;
+                    default:
+                        i_depth -= 3;
+                        stream << ".";
+                        need_separator = false;
+
+                        break;
+                    }
+                    if (i_depth == 0 && indented)
+                        stream << "\n";
+                }
+                i_depth += serialize_node(
+                    stream, indented, ident_level, c, need_separator);
+            }
+            depth += i_depth;
+        }
+        return depth;
+    }
+
+    struct parser_userdata
+    {
+        node *current;
+        bool fail;
+        parse_result result;
+
+        void set_error(const SNOT_DIAGNOSTIC &error)
+        {
+            if (fail)
+                return;
+
+            fail          = true;
+            result.code   = error.result;
+            result.offset = error.position.offset;
+            result.line   = error.position.line;
+            result.column = error.position.column;
+        }
+
+        // the callbacks reject tokens the tree can not hold
+        void set_error(SNOT_PARSER *parser)
+        {
+            SNOT_DIAGNOSTIC error;
+
+            error.result   = SNOT_ERROR_TOKEN_TYPE_UNDEFINED;
+            error.position = snot_position(parser);
+            set_error(error);
+        }
+    };
+
+    static SNOT_CALLBACKS callbacks()
+    {
+        SNOT_CALLBACKS cx;
+
+        cx.alloc         = malloc;
+        cx.free          = free;
+        cx.grow          = grow;
+        cx.shrink        = nullptr;
+        cx.start_section = start_section;
+        cx.end_section   = end_section;
+        cx.string        = string;
+        cx.number        = number;
+
+        return cx;
+    }
+
+    static void *grow(void *memory, size_t *size, size_t grow_size)
+    {
+        *size = *size + (((grow_size + 7) >> 3) << 3);
+        return realloc(memory, *size);
+    }
+
+    // builds the tree from an event, whether it came from a callback or a batch
+    static void add_event(SNOT_PARSER *parser,
+                          parser_userdata *u,
+                          const SNOT_EVENT &event)
+    {
+        if (u->fail)
+            return;
+
+        if (u->current == nullptr)
+        {
+            u->set_error(parser);
+            return;
+        }
+
+        const Allocator alloc = u->current->get_allocator();
+
+        switch (event.type)
+        {
+        case SNOT_EVENT_START_SECTION:
+            u->current = node::make(alloc,
+                                    u->current,
+                                    event.value,
+                                    event.length,
+                                    event.line,
+                                    alloc);
+            break;
+        case SNOT_EVENT_END_SECTION:
+            assert(u->current->name().compare(0,
+                                              u->current->name().size(),
+                                              event.value,
+                                              event.length) == 0);
+            if (u->current->name().compare(0,
+                                           u->current->name().size(),
+                                           event.value,
+                                           event.length) != 0)
+                u->set_error(parser);
+            else
+                u->current = u->current->parent();
+            break;
+        case SNOT_EVENT_STRING:
+            u->current->content().push_back(
+                value(event.value, event.length, value::string, alloc));
+            break;
+        case SNOT_EVENT_NUMBER:
+            {
+                typename value::type type;
+                switch (event.numberType)
+                {
+                case SNOT_DEC_NUMBER:
+                case SNOT_REAL_NUMBER:
+                    type = value::decimal;
+                    break;
+                case SNOT_OCT_NUMBER:
+                    type = value::octal;
+                    break;
+                case SNOT_HEX_NUMBER:
+                    type = value::hexadecimal;
+                    break;
+                default:
+                    u->set_error(parser);
+                    return;
+                }
+                u->current->content().push_back(
+                    value(event.value, event.length, type, alloc));
+            }
+            break;
+        }
+    }
+
+    static void add_token(SNOT_PARSER *parser,
+                          SNOT_EVENT_TYPE type,
+                          size_t id,
+                          void *userdata)
+    {
+        assert(parser);
+        assert(userdata);
+        SNOT_EVENT event;
+
+        event.type       = type;
+        event.id         = id;
+        event.parent     = snot_parent(parser, id);
+        event.numberType = SNOT_UNKOWN_NUMBER;
+        event.line       = snot_line(parser, id);
+        snot_value(parser, id, &event.value, &event.length);
+        if (type == SNOT_EVENT_NUMBER)
+            snot_number_type(parser, id, &event.numberType);
+
+        add_event(parser, (parser_userdata *)userdata, event);
+    }
+
+    static void start_section(SNOT_PARSER *parser, size_t id, void *userdata)
+    {
+        add_token(parser, SNOT_EVENT_START_SECTION, id, userdata);
+    }
+
+    static void end_section(SNOT_PARSER *parser, size_t id, void *userdata)
+    {
+        add_token(parser, SNOT_EVENT_END_SECTION, id, userdata);
+    }
+
+    static void string(SNOT_PARSER *parser, size_t id, void *userdata)
+    {
+        add_token(parser, SNOT_EVENT_STRING, id, userdata);
+    }
+
+    static void number(SNOT_PARSER *parser, size_t id, void *userdata)
+    {
+        add_token(parser, SNOT_EVENT_NUMBER, id, userdata);
+    }
+
+    static void batch(SNOT_PARSER *parser,
+                      const SNOT_EVENT *events,
+                      size_t count,
+                      void *userdata)
+    {
+        assert(parser);
+        assert(userdata);
+
+        for (size_t i = 0; i < count; i++)
+            add_event(parser, (parser_userdata *)userdata, events[i]);
+    }
+
+    // runs the tasks of snot_parse_parallel on up to *context threads
+    static void
+    run_tasks(SNOT_TASK task, void *data, size_t count, void *context)
+    {
+        const size_t threads = std::min<size_t>(*(unsigned *)context, count);
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> workers;
+
+        auto work = [&]() {
+            for (size_t i; (i = next++) < count;)
+                task(data, i);
+        };
+
+        for (size_t i = 1; i < threads; i++)
+            workers.emplace_back(work);
+        work();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    // parses a whole buffer with a parser from parsers(), leaving it reset
+    parse_result load_buffer(SNOT_PARSER *parser,
+                             const char *data,
+                             size_t length,
+                             bool ignore_fail)
+    {
+        parser_userdata userdata;
+        node *const root = make_root();
+
+        userdata.current = root;
+        userdata.fail    = false;
+
+        // the values are copied into the tree before the buffer goes away
+        snot_set_userdata(parser, &userdata);
+        snot_set_zero_copy(parser, SNOT_TRUE);
+
+        if (snot_parse_buffer(parser, data, length, nullptr) != SNOT_OK)
+            userdata.set_error(*snot_last_error(parser));
+        if (!userdata.fail && snot_end(parser) != SNOT_OK)
+            userdata.set_error(*snot_last_error(parser));
+
+        snot_reset(parser);
+        snot_set_userdata(parser, nullptr);
+
+        clear();
+        if (!ignore_fail && userdata.fail)
+            node::destroy(root);
+        else
+            m_root = root;
+
+        return userdata.result;
+    }
+
+    // parses a whole buffer on threads with a batched parser from parsers()
+    parse_result load_parallel(const char *data,
+                               size_t length,
+                               unsigned threads,
+                               bool ignore_fail)
+    {
+        parser_userdata userdata;
+        node *const root = make_root();
+
+        userdata.current = root;
+        userdata.fail    = false;
+
+        parser_pool::lease parser = parsers().acquire(&userdata);
+
+        // without batches, the input is parsed in sequence by the callbacks
+        snot_set_batch(parser, batch, 0);
+
+        // more parts than threads, so a wrong guess costs less
+        if (snot_parse_parallel(parser,
+                                data,
+                                length,
+                                nullptr,
+                                threads * 4,
+                                run_tasks,
+                                &threads) != SNOT_OK)
+            userdata.set_error(*snot_last_error(parser));
+
+        if (!userdata.fail && snot_end(parser) != SNOT_OK)
+            userdata.set_error(*snot_last_error(parser));
+
+        clear();
+        if (!ignore_fail && userdata.fail)
+            node::destroy(root);
+        else
+            m_root = root;
+
+        return userdata.result;
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    /*
+     * maps a regular file into memory and hands it to parse(data, length),
+     * other files are read in large chunks
+     */
+    template <typename Parse>
+    parse_result
+    load_mapped(const std::string &filename, Parse parse, bool ignore_fail)
+    {
+        parse_result result;
+        struct stat status;
+        void *data = MAP_FAILED;
+
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            result.code = SNOT_NEED_INPUT;
+            return result;
+        }
+
+        if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode) &&
+            status.st_size > 0)
+            data = mmap(
+                nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data != MAP_FAILED)
+        {
+            // the kernel reads ahead and may drop the pages already parsed
+            madvise(data, (size_t)status.st_size, MADV_SEQUENTIAL);
+            result = parse((const char *)data, (size_t)status.st_size);
+            munmap(data, (size_t)status.st_size);
+        }
+        else
+        {
+            // pipes, devices and empty files
+            result = load_chunks(
+                [fd](char *buffer, size_t size) -> long {
+                    ssize_t n;
+                    while ((n = ::read(fd, buffer, size)) < 0 && errno == EINTR)
+                        ;
+                    return (long)n;
+                },
+                ignore_fail);
+        }
+
+        ::close(fd);
+        return result;
+    }
+#endif
+
+    /*
+     * parses the chunks read(buffer, size) returns until it returns 0, a
+     * negative count is a read error
+     */
+    template <typename Read>
+    parse_result load_chunks(Read read, bool ignore_fail)
+    {
+        // grows up to 1 MiB while reads fill it, so short input stays cheap
+        size_t size = 4096;
+        std::unique_ptr<char[]> buffer(new char[size]);
+        parser_userdata userdata;
+        node *const root = make_root();
+
+        userdata.current = root;
+        userdata.fail    = false;
+
+        parser_pool::lease parser = parsers().acquire(&userdata);
+
+        while (!userdata.fail)
+        {
+            const long n = read(buffer.get(), size);
+            if (n <= 0)
+            {
+                if (n < 0)
+                {
+                    SNOT_DIAGNOSTIC error;
+
+                    error.result   = SNOT_NEED_INPUT;
+                    error.position = snot_position(parser);
+                    userdata.set_error(error);
+                }
+                break;
+            }
+
+            // multi-byte sequences split between chunks are resumed
+            if (snot_parse_buffer(parser, buffer.get(), (size_t)n, nullptr) !=
+                SNOT_OK)
+                userdata.set_error(*snot_last_error(parser));
+
+            if ((size_t)n == size && size < (1 << 20))
+            {
+                size *= 4;
+                buffer.reset(new char[size]);
+            }
+        }
+
+        if (!userdata.fail && snot_end(parser) != SNOT_OK)
+            userdata.set_error(*snot_last_error(parser));
+
+        clear();
+        if (!ignore_fail && userdata.fail)
+            node::destroy(root);
+        else
+            m_root = root;
+
+        return userdata.result;
+    }
+
+    // reads a whole file into buffer, keeping its capacity between files
+    static bool read_file(const std::string &filename, std::string &buffer)
+    {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+
+        const std::streamoff size = file.tellg();
+        if (size < 0)
+            return false;
+
+        buffer.resize((size_t)size);
+        file.seekg(0);
+        return (bool)file.read(&buffer[0], size);
+    }
+
+    friend std::vector<loaded_document>
+    load_many(const std::vector<std::string> &paths, unsigned threads);
+
+    // an empty root to load into
+    node *make_root()
+    {
+        return node::make(m_alloc,
+                          std::string("root"),
+                          std::initializer_list<value>(),
+                          -1,
+                          m_alloc);
+    }
+
+    void copy(const basic_document &doc)
+    {
+        if (doc.m_root)
+            m_root = node::make(m_alloc, *doc.m_root, m_alloc);
+        else
+            m_root = nullptr;
+    }
+};
+
+using document = basic_document<>;
+
+/**
+ * @brief A document loaded by load_many and where its load failed, if it did
+ */
+struct loaded_document
+{
+    document doc;
+    parse_result result;
+};
+
+/**
+ * @brief Loads the files of paths on several threads
+ *
+ * Each thread keeps one parser and one read buffer and takes the next file
+ * as soon as it is done with the last one, so a few large files do not hold
+ * up the rest.
+ *
+ * @param paths Filenames of SNOT documents
+ * @param threads Number of threads, 0 for one per core
+ * @return Returns the documents and the outcome of their load, in the order
+ * of paths
+ */
+inline std::vector<loaded_document>
+load_many(const std::vector<std::string> &paths, unsigned threads = 0)
+{
+    std::vector<loaded_document> loaded(paths.size());
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+
+    if (!threads)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto work = [&]() {
+        parser_pool::lease parser = document::parsers().acquire();
+        std::string buffer;
+
+        for (size_t i; (i = next++) < paths.size();)
+        {
+            loaded_document &l = loaded[i];
+
+            if (!document::read_file(paths[i], buffer))
+                l.result.code = SNOT_NEED_INPUT;
+            else
+                l.result = l.doc.load_buffer(
+                    parser, buffer.data(), buffer.size(), false);
+        }
+    };
+
+    for (size_t i = 1; i < std::min<size_t>(threads, paths.size()); i++)
+        workers.emplace_back(work);
+    work();
+    for (auto &worker : workers)
+        worker.join();
+
+    return loaded;
+}
+
+#ifdef SNOT_HAS_PMR
+namespace pmr
+{
+using value = basic_value<std::pmr::polymorphic_allocator<char>>;
+using node  = basic_node<std::pmr::polymorphic_allocator<char>>;
+
+// constructed before the document that allocates from it
+struct document_arena
+{
+    explicit document_arena(size_t initial_size) : m_arena(initial_size) {}
+
+    std::pmr::monotonic_buffer_resource m_arena;
+};
+
+/**
+ * @brief A document whose whole tree lives in its own monotonic arena
+ *
+ * Destroying it releases the arena in bulk without visiting the nodes.
+ * Loading again keeps the memory of the previous tree until then.
+ */
+class document : private document_arena,
+                 public basic_document<std::pmr::polymorphic_allocator<char>>
+{
+public:
+    /**
+     * @brief Creates an empty document
+     *
+     * @param initial_size Bytes of the first block of the arena
+     */
+    explicit document(size_t initial_size = 64 * 1024)
+        : document_arena(initial_size), basic_document(&m_arena)
+    {
+    }
+
+    /**
+     * @brief Deep copies the tree of doc into a new arena
+     */
+    document(const document &doc)
+        : document_arena(64 * 1024), basic_document(&m_arena)
+    {
+        basic_document::operator=(doc);
+    }
+
+    document &operator=(const document &doc)
+    {
+        basic_document::operator=(doc);
+        return *this;
+    }
+
+    ~document() { abandon(); }
+};
+} // namespace pmr
+#endif
+
+#ifdef SNOT_HAS_STRING_VIEW
+namespace view
+{
+class document;
+
+/**
+ * @brief A string or a number whose text is borrowed from its view::document
+ */
+class value : public value_base
+{
+public:
+    using string_type = std::string_view;
+
+    constexpr value(std::string_view text = std::string_view(),
+                    type type                 = string) noexcept
+        : m_type(type), m_value(text)
+    {
+    }
+
+    operator std::string_view() const noexcept { return m_value; }
+
+    template <
+        typename T,
+        typename U = typename std::enable_if<std::is_floating_point<T>::value ||
+                                                 std::is_integral<T>::value,
+                                             T>::type>
+    explicit operator U() const noexcept
+    {
+        return get_value<U>();
+    }
+
+    constexpr type get_type() const { return m_type; }
+
+    template <typename T,
+              typename =
+                  typename std::enable_if<!std::is_integral<T>::value, T>::type>
+    T get_value(float = 0) const noexcept
+    {
+        number_value n;
+        const number_kind kind =
+            parse_number(m_type, m_value.data(), m_value.size(), n);
+
+        assert(is_number());
+        return to_real(m_type, kind, n, T());
+    }
+
+    template <
+        typename T,
+        typename = typename std::enable_if<std::is_integral<T>::value, T>::type>
+    T get_value(int = 0) const noexcept
     {
-        copy(node);
+        number_value n;
+        const number_kind kind =
+            parse_number(m_type, m_value.data(), m_value.size(), n);
+
+        return to_integral<T>(m_type, kind, n);
     }
 
-    ~node() { free(); }
+    constexpr bool is_string() const noexcept { return m_type == string; }
 
-    node &operator=(const node &node)
+    constexpr bool is_number() const noexcept
     {
-        if (&node != this)
-        {
-            free();
-            copy(node);
-        }
-        return *this;
+        return m_type == decimal || m_type == octal || m_type == hexadecimal;
     }
 
-    // creation methods
-    node(const std::string &name,
-         std::initializer_list<value> content = {},
-         int lineNo                           = -1)
-        : m_name(name), m_content(content), m_parent(nullptr),
-          m_children(nullptr), m_last_children(nullptr), m_next(nullptr),
-          m_lineNo(lineNo)
-    {
-    }
-    void add_child(node &child)
+private:
+    type m_type;
+    std::string_view m_value;
+};
+
+/**
+ * @brief A section of a view::document, it can not be changed
+ */
+class node
+{
+public:
+    using value       = view::value;
+    using string_type = std::string_view;
+    using name_view   = std::string_view;
+
+    // the values of a node, side by side in its document
+    class content_type
     {
-        if (m_children == nullptr)
-        {
-            m_children      = &child;
-            m_last_children = &child;
-        }
-        else
-        {
-            m_last_children->m_next = &child;
-            m_last_children         = &child;
-        }
-        child.m_next   = nullptr;
-        child.m_parent = this;
-    }
+    public:
+        using value_type     = view::value;
+        using iterator       = const value *;
+        using const_iterator = const value *;
 
-    bool insert_child(node &child, node &following_node)
+        const value *begin() const noexcept { return m_begin; }
+        const value *end() const noexcept { return m_begin + m_size; }
+
+        size_t size() const noexcept { return m_size; }
+        bool empty() const noexcept { return m_size == 0; }
+
+        const value &operator[](size_t i) const noexcept { return m_begin[i]; }
+
+    private:
+        friend class document;
+
+        value *m_begin = nullptr;
+        size_t m_size  = 0;
+    };
+
+    struct const_iterator
     {
-        if (following_node.m_parent != this)
-            return false;
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = const node;
+        using pointer           = value_type *;
+        using reference         = value_type &;
 
-        if (m_children == &following_node)
+        const_iterator(pointer ptr) : m_ptr(ptr) {}
+
+        reference operator*() const { return *m_ptr; }
+        pointer operator->() const { return m_ptr; }
+
+        const_iterator &operator++()
         {
-            child.m_next = m_children;
-            m_children   = &child;
+            if (m_ptr != nullptr)
+                m_ptr = m_ptr->m_next;
+            return *this;
         }
-        else
+
+        const_iterator operator++(int)
         {
-            node *ch = m_children;
-            while (ch && ch->m_next != &following_node)
-                ch = ch->m_next;
-            if (!ch)
-                return false;
-            child.m_next = &following_node;
-            ch->m_next   = &child;
+            const_iterator tmp = *this;
+            ++(*this);
+            return tmp;
         }
-        child.m_parent = this;
-        return true;
-    }
-
-    bool insert_child_after(node &child, node &preceding_node)
-    {
-        if (preceding_node.m_parent != this)
-            return false;
-
-        child.m_next          = preceding_node.m_next;
-        preceding_node.m_next = &child;
-        child.m_parent        = this;
-        if (&preceding_node == m_last_children)
-            m_last_children = &child;
-        return true;
-    }
 
-    bool remove_child(node &child)
-    {
-        if (child.m_parent != this)
-            return false;
-        if (m_children == &child)
+        friend bool operator==(const const_iterator &a,
+                               const const_iterator &b)
         {
-            if (m_children != m_last_children)
-                m_children = child.m_next;
-            else
-                m_last_children = m_children = nullptr;
-            goto remove;
+            return a.m_ptr == b.m_ptr;
         }
+
+        friend bool operator!=(const const_iterator &a,
+                               const const_iterator &b)
         {
-            node *ch = m_children;
-            while (ch->m_next)
-            {
-                if (ch->m_next == &child)
-                {
-                    ch->m_next = child.m_next;
-                    if (&child == m_last_children)
-                        m_last_children = ch;
-                    goto remove;
-                }
-                ch = ch->m_next;
-            }
+            return a.m_ptr != b.m_ptr;
         }
-        return false;
-    remove:
-        child.m_parent = nullptr;
-        child.m_next   = nullptr;
-        return true;
-    }
 
-    // access methods
-    std::string &name() { return m_name; }
-    const std::string &name() const { return m_name; }
+    private:
+        pointer m_ptr;
+    };
+    using iterator = const_iterator;
 
-    std::vector<value> &content() { return m_content; }
-    const std::vector<value> &content() const { return m_content; }
+    node(const node &)            = delete;
+    node &operator=(const node &) = delete;
 
-    node *&parent() { return m_parent; }
-    const node *parent() const { return m_parent; }
+    std::string_view name() const noexcept { return m_name; }
+    const content_type &content() const noexcept { return m_content; }
+    const node *parent() const noexcept { return m_parent; }
 
-    int depth(node *grand_parent = nullptr) const
+    int depth(const node *grand_parent = nullptr) const
     {
         const node *n = this;
         int ret       = -1;
@@ -586,64 +2429,42 @@ public:
         return EOF;
     }
 
-    iterator begin() { return iterator(m_children); }
-    iterator end() { return iterator(nullptr); }
-
     const_iterator begin() const { return const_iterator(m_children); }
     const_iterator end() const { return const_iterator(nullptr); }
 
     const_iterator cbegin() const { return const_iterator(m_children); }
     const_iterator cend() const { return const_iterator(nullptr); }
 
-    bool at(const std::string &node_name, iterator *value)
-    {
-        for (auto &i : *this)
-        {
-            if (i.name() == node_name)
-            {
-                if (value)
-                    *value = iterator(&i);
-                return true;
-            }
-        }
-        return false;
-    }
-
-    bool at(const std::string &node_name, const_iterator *value) const
+    /**
+     * @brief Finds the first child named node_name, walking the children
+     */
+    bool at(name_view node_name, const_iterator *value) const
     {
-        for (const auto &i : *this)
+        for (const node *c = m_children; c; c = c->m_next)
         {
-            if (i.name() == node_name)
+            if (c->m_name == node_name)
             {
                 if (value)
-                    *value = const_iterator(&i);
+                    *value = const_iterator(c);
                 return true;
             }
         }
         return false;
     }
 
-    iterator at(const std::string &node_name) noexcept
-    {
-        iterator it = end();
-        at(node_name, &it);
-        return it;
-    }
-
-    const_iterator at(const std::string &node_name) const noexcept
+    const_iterator at(name_view node_name) const noexcept
     {
         const_iterator it = end();
         at(node_name, &it);
         return it;
     }
 
-    bool has(const std::string &node_name) const noexcept
+    bool has(name_view node_name) const noexcept
     {
         return at(node_name, nullptr);
     }
 
-    iterator operator[](const std::string &node_name) { return at(node_name); }
-    const_iterator operator[](const std::string &node_name) const
+    const_iterator operator[](name_view node_name) const
     {
         return at(node_name);
     }
@@ -651,436 +2472,444 @@ public:
     int lineNo() const { return m_lineNo; }
 
 private:
-    std::string m_name;
-    std::vector<value> m_content;
-
-    node *m_parent, *m_children, *m_last_children, *m_next;
-    size_t m_lineNo;
-
-    void free()
-    {
-        node *c, *c2;
-        for (c = m_children; c; c = c2)
-        {
-            c2 = c->m_next;
-            delete c;
-        }
-    }
+    friend class document;
 
-    void copy(const node &n)
-    {
-        m_name          = n.m_name;
-        m_content       = n.m_content;
-        m_lineNo        = n.m_lineNo;
-        m_children      = nullptr;
-        m_last_children = nullptr;
+    node() = default;
 
-        for (auto &c : n)
-            add_child(*new node(c));
-    }
+    std::string_view m_name;
+    content_type m_content;
+    node *m_parent   = nullptr;
+    node *m_children = nullptr;
+    node *m_next     = nullptr;
+    size_t m_lineNo  = -1;
 };
 
+/**
+ * @brief A read-only document whose names and values borrow from its text
+ *
+ * Files are mapped into memory where possible and other input is read once
+ * into the document, which then owns it. Only the strings the parser had to
+ * rewrite, those with escapes or continuations, are copied. Nodes and values
+ * are packed into a few large blocks and freed with the document. copy_to
+ * gives a tree that can be changed.
+ */
 class document
 {
 public:
-    /**
-     * @brief Default constructor
-     */
-    document() : m_root(nullptr) {}
+    using node  = view::node;
+    using value = view::value;
 
-    /**
-     * @brief Loads the given filename
-     */
-    document(const std::string &filename) : m_root(nullptr)
-    {
-        if (!load_file(filename))
-            delete m_root;
-    }
+    document() = default;
 
     /**
-     * @brief Loads the given SNOT document from given stream.
+     * @brief Loads a SNOT document file
      */
-    document(std::basic_istream<char> &stream) : m_root(nullptr)
-    {
-        if (!load_stream(stream))
-            delete m_root;
-    }
+    explicit document(const std::string &filename) { load_file(filename); }
 
-    /**
-     * @brief Copy costructor
-     *
-     * Deep copies all the SNOT tree of the given document
-     */
-    document(const document &doc) : m_root(nullptr) { copy(doc); }
+    // the nodes point into the document itself
+    document(const document &)            = delete;
+    document &operator=(const document &) = delete;
 
-    /**
-     * @brief Frees the document root node
-     */
-    ~document() { delete m_root; }
+    ~document() { clear(); }
 
     /**
-     * @brief Deep copies the document
+     * @brief Frees the tree and the text, the document is no longer ok
      */
-    document &operator=(const document &doc)
+    void clear()
     {
-        delete m_root;
-        copy(doc);
-        return *this;
+        m_root = nullptr;
+        m_blocks.clear();
+        m_free       = nullptr;
+        m_left       = 0;
+        m_block_size = 2048;
+        std::string().swap(m_text);
+#if defined(__unix__) || defined(__APPLE__)
+        if (m_map)
+            munmap(m_map, m_map_size);
+        m_map = nullptr;
+#endif
     }
 
     /**
      * @brief Parses filename as an SNOT document file and loads its data
      *
-     * @param filename Filename for SNOT document
-     * @return Returns true if successful, otherwise false
-     */
-    bool load_file(const std::string &filename, bool ignore_fail = false)
-    {
-        std::ifstream file;
-        file.open(filename);
-        if (!file)
-            return false;
-        return load_stream(file, ignore_fail);
-    }
-
-    /**
-     * @brief Parses the contents as SNOT document and loads its data
-     *
-     * @param contents String that contains a SNOT document data
-     * @return Returns true if successful, otherwise false
-     */
-    bool load_string(const char *contents, bool ignore_fail = false)
-    {
-        std::stringstream ss(contents);
-        return load_stream(ss, ignore_fail);
-    }
-
-    /**
-     * @brief Parses the contents as SNOT document and loads its data
-     *
-     * @param contents String that contains a SNOT document data
-     * @return Returns true if successful, otherwise false
-     */
-    bool load_string(const std::string &contents, bool ignore_fail = false)
-    {
-        std::stringstream ss(contents);
-        return load_stream(ss, ignore_fail);
-    }
-
-    /**
-     * @brief Parses the data of a given stream as a SNOT document and loads its
-     * data
+     * On POSIX systems a regular file stays mapped into memory as long as
+     * the document uses it, and must not change in the meantime.
      *
-     * @param stream Stream that contains a SNOT document data
-     * @return Returns true if successful, otherwise false
+     * @param filename Filename for SNOT document
+     * @return Returns where the first error happened, if any
      */
-    bool load_stream(std::basic_istream<char> &stream, bool ignore_fail = false)
+    parse_result load_file(const std::string &filename,
+                           bool ignore_fail = false)
     {
-        SNOT_PARSER *parser;
-        parser_userdata userdata;
-        SNOT_CALLBACKS cx;
-
-        cx.alloc         = malloc;
-        cx.free          = free;
-        cx.grow          = grow;
-        cx.start_section = start_section;
-        cx.end_section   = end_section;
-        cx.string        = string;
-        cx.number        = number;
-
-        node *const root = new node("root");
-
-        userdata.current = root;
-        userdata.fail    = false;
+        clear();
+#if defined(__unix__) || defined(__APPLE__)
+        parse_result result;
+        struct stat status;
+        void *data = MAP_FAILED;
+
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            result.code = SNOT_NEED_INPUT;
+            return result;
+        }
 
-        parser = snot_create(cx, &userdata);
+        if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode) &&
+            status.st_size > 0)
+            data = mmap(
+                nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
 
-        std::basic_istream<char>::int_type c;
-        while (c = stream.get(),
-               c != std::basic_istream<char>::traits_type::eof())
+        if (data != MAP_FAILED)
         {
-            snot_parse(parser, c);
+            m_map      = data;
+            m_map_size = (size_t)status.st_size;
+
+            // sequential while parsing, lookups may then go anywhere
+            madvise(m_map, m_map_size, MADV_SEQUENTIAL);
+            result = parse((const char *)m_map, m_map_size, ignore_fail);
+            if (m_map)
+                madvise(m_map, m_map_size, MADV_NORMAL);
         }
-
-        size_t columnNo = 0;
-        while (!stream.eof() && !stream.bad() && !stream.fail())
+        else
         {
-            const uint32_t c = decode_utf8(stream);
-            columnNo++;
-            if (c == '\n')
-            {
-                userdata.lineNo++;
-                columnNo = 0;
-            }
-
-            // fill the parser each with character at a time
-            const SNOT_RESULT result = snot_parse(parser, c);
-            switch (result)
-            {
-            case SNOT_OK:
-                break;
-            case SNOT_ERROR_NO_MEMORY:
-            case SNOT_ERROR_INVALID_CHARACTER:
-            case SNOT_ERROR_PARTIAL:
-            case SNOT_ERROR_TOKEN_TYPE_UNDEFINED:
-                fprintf(stderr,
-                        "%zu:%zu: error at %c(code: %d)\n",
-                        userdata.lineNo,
-                        columnNo,
-                        c,
-                        result);
-                break;
-            default:
-                fprintf(stderr,
-                        "%zu:%zu: unknown error at %c(code: %d)\n",
-                        userdata.lineNo,
-                        columnNo,
-                        c,
-                        result);
-                break;
-            }
+            // pipes, devices and empty files
+            result = load_chunks(
+                [fd](char *buffer, size_t size) -> long {
+                    ssize_t n;
+                    while ((n = ::read(fd, buffer, size)) < 0 && errno == EINTR)
+                        ;
+                    return (long)n;
+                },
+                ignore_fail);
         }
 
-        snot_end(parser);
-        snot_free(parser);
-
-        if (!ignore_fail && userdata.fail)
-            delete root;
-        else
-            m_root = root;
+        ::close(fd);
+        return result;
+#else
+        std::ifstream file;
+        file.open(filename, std::ios::binary);
+        if (!file)
+        {
+            parse_result result;
+            result.code = SNOT_NEED_INPUT;
+            return result;
+        }
+        return load_stream(file, ignore_fail);
+#endif
+    }
 
-        return !userdata.fail;
+    /**
+     * @brief Parses the contents as SNOT document and keeps them
+     *
+     * @param contents String that contains a SNOT document data, moved into
+     * the document
+     * @return Returns where the first error happened, if any
+     */
+    parse_result load_string(std::string contents, bool ignore_fail = false)
+    {
+        clear();
+        m_text = std::move(contents);
+        return parse(m_text.data(), m_text.size(), ignore_fail);
     }
 
     /**
-     * @brief Saves a SNOT document to a file
+     * @brief Parses a copy of length bytes of data as a SNOT document
      *
-     * @param filename Filename to save
-     * @param indented if enabled, the file will be indented
-     * @return Returns true if successful, otherwise false
+     * @param data Buffer that holds a whole SNOT document
+     * @param length Bytes in data
+     * @return Returns where the first error happened, if any
      */
-    bool save_file(const std::string &filename, bool indented = false)
+    parse_result
+    load_buffer(const char *data, size_t length, bool ignore_fail = false)
     {
-        std::ofstream file;
-        file.open(filename);
-        return save_stream(file, indented);
+        clear();
+        m_text.assign(data, length);
+        return parse(m_text.data(), m_text.size(), ignore_fail);
     }
 
     /**
-     * @brief Saves a SNOT document to a stream
+     * @brief Reads the whole stream and parses it as a SNOT document
      *
-     * @param stream Stream to save
-     * @param indented if enabled, the file will be indented
-     * @return Returns true if successful, otherwise false
+     * @param stream Stream that contains a SNOT document data
+     * @return Returns where the first error happened, if any
      */
-    bool save_stream(std::basic_ostream<char> &stream, bool indented = false)
+    parse_result load_stream(std::basic_istream<char> &stream,
+                             bool ignore_fail = false)
     {
-        if (!ok())
-            return false;
+        std::streambuf *const buffer = stream.rdbuf();
+
+        clear();
+        return load_chunks(
+            [&stream, buffer](char *data, size_t size) -> long {
+                const std::streamsize n =
+                    buffer ? buffer->sgetn(data, (std::streamsize)size) : 0;
+                if (!n)
+                    stream.setstate(std::ios::eofbit);
+                return (long)n;
+            },
+            ignore_fail);
+    }
 
-        const node &n = *m_root;
-        serialize_node(stream, indented, 0, n, false, false);
-        return true;
+    /**
+     * @brief Deep copies the tree into doc, where it can be changed
+     */
+    template <typename Allocator>
+    void copy_to(basic_document<Allocator> &doc) const
+    {
+        using target          = basic_node<Allocator>;
+        using values          = std::initializer_list<typename target::value>;
+        const Allocator alloc = doc.get_allocator();
+
+        doc.clear();
+        if (!m_root)
+            return;
+
+        doc.root() =
+            target::make(alloc, std::string("root"), values(), -1, alloc);
+        copy_node(*m_root, doc.root(), alloc);
     }
 
     /**
-     * @brief Gets reference to root node pointer
+     * @brief Parsers reused by every load, see parser_pool
      */
-    node *&root() { return m_root; }
+    static parser_pool &parsers()
+    {
+        static parser_pool pool(callbacks());
+        return pool;
+    }
 
     /**
      * @brief Gets root node pointer
      */
-    node *root() const { return m_root; }
+    const node *root() const { return m_root; }
 
     /**
      * @brief Checks if document has been loaded succesfully
      *
      * @return Returns true if successful, otherwise false
      */
-    constexpr bool ok() const { return root() != nullptr; }
+    bool ok() const { return root() != nullptr; }
 
 private:
-    node *m_root;
+    node *m_root = nullptr;
 
-    static bool serialize_value(std::basic_ostream<char> &stream,
-                                bool indented,
-                                const value &n,
-                                bool need_separator)
+    // the text of the document unless it is mapped
+    std::string m_text;
+#if defined(__unix__) || defined(__APPLE__)
+    void *m_map       = nullptr;
+    size_t m_map_size = 0;
+#endif
+
+    // blocks for the nodes, the values and the text the parser rewrote
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    char *m_free        = nullptr;
+    size_t m_left       = 0;
+    size_t m_block_size = 2048;
+
+    struct parser_userdata
     {
-        const std::string &str = n;
-        const bool has_space =
-            str.find_first_of(" ,;.()\\") != std::string::npos;
-        if (has_space)
+        document *doc;
+        const char *begin, *end; // the text values may borrow from
+        node *current;
+        std::vector<node *> last; // the last child of each open section
+        std::vector<std::pair<node *, value>> values;
+        bool fail;
+        parse_result result;
+
+        void set_error(const SNOT_DIAGNOSTIC &error)
         {
-            if (indented)
-                stream << " ";
-            stream << "\"" << str << "\"";
-            need_separator = false;
+            if (fail)
+                return;
+
+            fail          = true;
+            result.code   = error.result;
+            result.offset = error.position.offset;
+            result.line   = error.position.line;
+            result.column = error.position.column;
         }
-        else
+
+        // the callbacks reject tokens the tree can not hold
+        void set_error(SNOT_PARSER *parser)
         {
-            if (need_separator)
-                stream << " ";
-            stream << str;
-            need_separator = true;
+            SNOT_DIAGNOSTIC error;
+
+            error.result   = SNOT_ERROR_TOKEN_TYPE_UNDEFINED;
+            error.position = snot_position(parser);
+            set_error(error);
         }
-        return need_separator;
-    }
+    };
 
-    static bool serialize_content(std::basic_ostream<char> &stream,
-                                  bool indented,
-                                  const node &n,
-                                  bool need_separator)
+    void *allocate(size_t size, size_t align)
     {
-        bool first = true;
-        for (auto const &f : n.content())
+        size_t skip = (size_t)(-(uintptr_t)m_free & (align - 1));
+
+        if (skip + size > m_left)
         {
-            const std::string &value = f;
+            // twice the last block up to 1 MiB, larger requests get their own
+            m_block_size = std::min<size_t>(m_block_size * 2, 1 << 20);
+            m_left       = std::max(size, m_block_size);
+            m_blocks.emplace_back(new char[m_left]);
+            m_free = m_blocks.back().get();
+            skip   = 0;
+        }
 
-            if (first)
-                first = false;
-            else
-            {
-                stream << ",";
-                need_separator = false;
-            }
+        void *const memory = m_free + skip;
+        m_free += skip + size;
+        m_left -= skip + size;
+        return memory;
+    }
 
-            need_separator =
-                serialize_value(stream, indented, f, need_separator);
-        }
-        return need_separator;
+    node *make_node(node *parent, std::string_view name, size_t lineNo)
+    {
+        node *const n = ::new (allocate(sizeof(node), alignof(node))) node();
+
+        n->m_name   = name;
+        n->m_parent = parent;
+        n->m_lineNo = lineNo;
+        return n;
     }
 
-    static int serialize_node(std::basic_ostream<char> &stream,
-                              bool indented,
-                              int ident_level,
-                              const node &n,
-                              bool need_separator,
-                              bool show_name = true)
+    // borrows the text when it lies in the input, copies it otherwise
+    std::string_view text(const parser_userdata &u, const SNOT_EVENT &event)
     {
-        int depth = 0;
-        const std::string sp(ident_level, ' ');
+        const std::less_equal<const char *> before;
 
-        if (indented)
-        {
-            stream << sp;
-            need_separator = false;
-        }
+        if (before(u.begin, event.value) &&
+            before(event.value + event.length, u.end))
+            return std::string_view(event.value, event.length);
 
-        if (show_name)
-        {
-            if (indented)
-                ident_level += 2;
-            need_separator =
-                serialize_value(stream, indented, n.name(), need_separator);
-            depth++;
-        }
+        char *const copy = (char *)allocate(event.length, 1);
+        memcpy(copy, event.value, event.length);
+        return std::string_view(copy, event.length);
+    }
+
+    parse_result parse(const char *data, size_t length, bool ignore_fail)
+    {
+        parser_userdata userdata;
+
+        m_root = make_node(nullptr, "root", -1);
+
+        userdata.doc     = this;
+        userdata.begin   = data;
+        userdata.end     = data + length;
+        userdata.current = m_root;
+        userdata.fail    = false;
+        userdata.last.push_back(nullptr);
 
-        if (n.begin() != n.end() && indented) // multiple lines
         {
-            if (show_name)
-                stream << "\n";
-            if (!n.content().empty() && indented)
-                stream << sp << "  ";
+            parser_pool::lease parser = parsers().acquire(&userdata);
+
+            snot_set_zero_copy(parser, SNOT_TRUE);
+            if (snot_parse_buffer(parser, data, length, nullptr) != SNOT_OK)
+                userdata.set_error(*snot_last_error(parser));
+            if (!userdata.fail && snot_end(parser) != SNOT_OK)
+                userdata.set_error(*snot_last_error(parser));
         }
 
-        need_separator = serialize_content(stream, indented, n, need_separator);
-        if (!n.content().empty())
-            depth++;
+        if (!ignore_fail && userdata.fail)
+            clear();
+        else
+            place_values(userdata.values);
 
-        if (n.begin() != n.end())
-        {
-            if (!n.content().empty())
-            {
-                stream << ",";
-                depth--;
-                if (indented)
-                    stream << "\n";
-            }
+        return userdata.result;
+    }
 
-            int i_depth = 0;
-            for (auto const &c : n)
-            {
-                while (i_depth)
-                {
-                    switch (i_depth)
-                    {
-                    case 1:
-                        i_depth -= 1;
-                        stream << ",";
-                        need_separator = false;
-                        break;
-                    case 2:
-                        i_depth -= 2;
-                        stream << ";";
-                        need_separator = false;
-                        break;
-                    default:
-                        i_depth -= 3;
-                        stream << ".";
-                        need_separator = false;
+    // gives every node its values as one range, in the order they came
+    void place_values(const std::vector<std::pair<node *, value>> &values)
+    {
+        value *end = (value *)allocate(values.size() * sizeof(value),
+                                       alignof(value));
 
-                        break;
-                    }
-                    if (i_depth == 0 && indented)
-                        stream << "\n";
-                }
-                i_depth += serialize_node(
-                    stream, indented, ident_level, c, need_separator);
+        // first at the end of its range, moved back as it is filled
+        for (const auto &v : values)
+        {
+            if (!v.first->m_content.m_begin)
+            {
+                end += v.first->m_content.m_size;
+                v.first->m_content.m_begin = end;
             }
-            depth += i_depth;
         }
-        return depth;
+        for (auto v = values.rbegin(); v != values.rend(); ++v)
+            ::new ((void *)--v->first->m_content.m_begin) value(v->second);
     }
 
-    struct parser_userdata
+    /*
+     * parses the chunks read(buffer, size) returns until it returns 0, a
+     * negative count is a read error
+     */
+    template <typename Read>
+    parse_result load_chunks(Read read, bool ignore_fail)
     {
-        node *current;
-        bool fail;
-        size_t lineNo;
-    };
+        size_t used = 0;
 
-    static uint32_t decode_utf8_continuation(std::basic_istream<char> &stream,
-                                             uint32_t result,
-                                             int count)
-    {
-        for (; count; --count)
+        for (;;)
         {
-            std::basic_istream<char>::int_type next = stream.get();
-            if (next == std::char_traits<char>::eof() ||
-                (next & 0xC0) != 0x80) // valid 10xx_xxxx
+            // as much as was read so far, from 4 KiB up to 1 MiB
+            const size_t size =
+                std::min<size_t>(std::max<size_t>(used, 4096), 1 << 20);
+            m_text.resize(used + size);
+
+            const long n = read(&m_text[used], size);
+            if (n < 0)
             {
-                // not a valid continuation character
-                stream.setstate(std::ios::badbit);
-                return -1;
+                parse_result result;
+
+                clear();
+                result.code = SNOT_NEED_INPUT;
+                return result;
             }
-            result = (result << 6) | (next & 0x3F);
+            if (n == 0)
+                break;
+            used += (size_t)n;
         }
-        return result;
+
+        // the text is kept as long as the document
+        m_text.resize(used);
+        m_text.shrink_to_fit();
+        return parse(m_text.data(), m_text.size(), ignore_fail);
     }
 
-    static uint32_t decode_utf8(std::basic_istream<char> &stream)
+    template <typename Allocator>
+    static void copy_node(const node &from,
+                          basic_node<Allocator> *to,
+                          const Allocator &alloc)
     {
-        std::basic_istream<char>::int_type next = stream.get();
-        if (next == std::char_traits<char>::eof())
+        using target = basic_node<Allocator>;
+
+        to->content().reserve(from.content().size());
+        for (const value &v : from.content())
         {
-            stream.setstate(std::ios::badbit);
-            return -1;
+            const std::string_view text = v;
+            to->content().push_back(typename target::value(
+                text.data(), text.size(), v.get_type(), alloc));
         }
 
-        std::basic_istream<char>::int_type mask;
-        if (mask = 0x80, (next & mask) == 0x00) // 1-byte
-            return next & ~0x80;
-        else if (mask = 0xE0, (next & mask) == 0xC0) // 2-byte
-            return decode_utf8_continuation(stream, next & ~mask, 1);
-        else if (mask = 0xF0, (next & mask) == 0xE0) // 3-byte
-            return decode_utf8_continuation(stream, next & ~mask, 2);
-        else if (mask = 0xF8, (next & mask) == 0xF0) // 3-byte
-            return decode_utf8_continuation(stream, next & ~mask, 3);
+        for (const node &c : from)
+            copy_node(c,
+                      target::make(alloc,
+                                   to,
+                                   c.name().data(),
+                                   c.name().size(),
+                                   (size_t)c.lineNo(),
+                                   alloc),
+                      alloc);
+    }
+
+    static SNOT_CALLBACKS callbacks()
+    {
+        SNOT_CALLBACKS cx;
+
+        cx.alloc         = malloc;
+        cx.free          = free;
+        cx.grow          = grow;
+        cx.shrink        = nullptr;
+        cx.start_section = start_section;
+        cx.end_section   = end_section;
+        cx.string        = string;
+        cx.number        = number;
 
-        stream.setstate(std::ios::badbit);
-        return -1;
+        return cx;
     }
 
     static void *grow(void *memory, size_t *size, size_t grow_size)
@@ -1089,104 +2918,114 @@ private:
         return realloc(memory, *size);
     }
 
-    static void start_section(SNOT_PARSER *parser, size_t id, void *userdata)
+    static void add_event(SNOT_PARSER *parser,
+                          parser_userdata *u,
+                          const SNOT_EVENT &event)
     {
-        assert(parser);
-        assert(userdata);
-        parser_userdata *u = (parser_userdata *)userdata;
-
         if (u->fail)
             return;
 
-        const char *name;
-        snot_value(parser, id, &name, NULL);
-
-        u->current = new node(u->current, std::string(name));
+        switch (event.type)
+        {
+        case SNOT_EVENT_START_SECTION:
+            {
+                node *const n = u->doc->make_node(
+                    u->current, u->doc->text(*u, event), event.line);
+
+                // appended after the last child, without walking to it
+                if (u->last.back())
+                    u->last.back()->m_next = n;
+                else
+                    u->current->m_children = n;
+                u->last.back() = n;
+                u->last.push_back(nullptr);
+                u->current = n;
+            }
+            break;
+        case SNOT_EVENT_END_SECTION:
+            if (!u->current->m_parent ||
+                u->current->m_name !=
+                    std::string_view(event.value, event.length))
+                u->set_error(parser);
+            else
+            {
+                u->last.pop_back();
+                u->current = u->current->m_parent;
+            }
+            break;
+        case SNOT_EVENT_STRING:
+            u->values.emplace_back(
+                u->current, value(u->doc->text(*u, event), value::string));
+            u->current->m_content.m_size++;
+            break;
+        case SNOT_EVENT_NUMBER:
+            {
+                value::type type;
+                switch (event.numberType)
+                {
+                case SNOT_DEC_NUMBER:
+                case SNOT_REAL_NUMBER:
+                    type = value::decimal;
+                    break;
+                case SNOT_OCT_NUMBER:
+                    type = value::octal;
+                    break;
+                case SNOT_HEX_NUMBER:
+                    type = value::hexadecimal;
+                    break;
+                default:
+                    u->set_error(parser);
+                    return;
+                }
+                u->values.emplace_back(u->current,
+                                       value(u->doc->text(*u, event), type));
+                u->current->m_content.m_size++;
+            }
+            break;
+        }
     }
 
-    static void end_section(SNOT_PARSER *parser, size_t id, void *userdata)
+    static void add_token(SNOT_PARSER *parser,
+                          SNOT_EVENT_TYPE type,
+                          size_t id,
+                          void *userdata)
     {
         assert(parser);
         assert(userdata);
-        parser_userdata *u = (parser_userdata *)userdata;
-
-        if (u->fail)
-            return;
-
-        const char *name;
-        snot_value(parser, id, &name, NULL);
-
-        assert(u->current);
-        assert(u->current->name() == name);
-        if (u->current == nullptr || u->current->name() != name)
-            u->fail = true;
-        else
-            u->current = u->current->parent();
+        SNOT_EVENT event;
+
+        event.type       = type;
+        event.id         = id;
+        event.parent     = snot_parent(parser, id);
+        event.numberType = SNOT_UNKOWN_NUMBER;
+        event.line       = snot_line(parser, id);
+        snot_value(parser, id, &event.value, &event.length);
+        if (type == SNOT_EVENT_NUMBER)
+            snot_number_type(parser, id, &event.numberType);
+
+        add_event(parser, (parser_userdata *)userdata, event);
     }
 
-    static void string(SNOT_PARSER *parser, size_t id, void *userdata)
+    static void start_section(SNOT_PARSER *parser, size_t id, void *userdata)
     {
-        assert(parser);
-        assert(userdata);
-        parser_userdata *u = (parser_userdata *)userdata;
-
-        if (u->fail)
-            return;
-
-        const char *str;
-        snot_value(parser, id, &str, NULL);
-
-        if (u->current == nullptr)
-            u->fail = true;
-        else
-            u->current->content().push_back(value(str));
+        add_token(parser, SNOT_EVENT_START_SECTION, id, userdata);
     }
 
-    static void number(SNOT_PARSER *parser, size_t id, void *userdata)
+    static void end_section(SNOT_PARSER *parser, size_t id, void *userdata)
     {
-        assert(parser);
-        assert(userdata);
-        parser_userdata *u = (parser_userdata *)userdata;
-
-        if (u->fail)
-            return;
-
-        const char *str;
-        snot_value(parser, id, &str, NULL);
-
-        if (u->current == nullptr)
-            u->fail = true;
-        else
-        {
-            SNOT_NUMBER_TYPE numberType;
-            snot_number_type(parser, id, &numberType);
+        add_token(parser, SNOT_EVENT_END_SECTION, id, userdata);
+    }
 
-            value::type type;
-            switch (numberType)
-            {
-            case SNOT_DEC_NUMBER:
-                type = value::decimal;
-                break;
-            case SNOT_OCT_NUMBER:
-                type = value::octal;
-                break;
-            case SNOT_HEX_NUMBER:
-                type = value::hexadecimal;
-                break;
-            default:
-                u->fail = true;
-                return;
-            }
-            u->current->content().push_back(value(str, type));
-        }
+    static void string(SNOT_PARSER *parser, size_t id, void *userdata)
+    {
+        add_token(parser, SNOT_EVENT_STRING, id, userdata);
     }
 
-    void copy(const document &doc)
+    static void number(SNOT_PARSER *parser, size_t id, void *userdata)
     {
-        if (doc.m_root)
-            m_root = new node(*doc.m_root);
-        else
-            m_root = nullptr;
+        add_token(parser, SNOT_EVENT_NUMBER, id, userdata);
     }
 };
+} // namespace view
+#endif
 } // namespace snot
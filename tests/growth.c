@@ -0,0 +1,195 @@
+/*
+ * Counts the calls to the grow callback while parsing generated documents.
+ *
+ * The token stack and the string pool double as they grow, so a document of
+ * n bytes must not take more than a few times log2(n) calls, and none once
+ * snot_reserve has made room for it.
+ */
+#include <snot.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned long _grows = 0;
+
+static void *_grow(void *memory, size_t *size, size_t grow_size)
+{
+    _grows++;
+    *size += grow_size;
+    return realloc(memory, *size);
+}
+
+static void _event(SNOT_PARSER *p, size_t id, void *userdata)
+{
+    (void)p;
+    (void)id;
+    (void)userdata;
+}
+
+static SNOT_PARSER *_create(void)
+{
+    SNOT_CALLBACKS cx;
+
+    cx.alloc         = malloc;
+    cx.free          = free;
+    cx.grow          = _grow;
+    cx.shrink        = NULL;
+    cx.start_section = _event;
+    cx.end_section   = _event;
+    cx.string        = _event;
+    cx.number        = _event;
+
+    return snot_create(cx, NULL);
+}
+
+typedef struct _TEXT
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+} TEXT;
+
+static void _append(TEXT *t, const char *s, size_t length)
+{
+    if (t->length + length > t->capacity)
+    {
+        fprintf(stderr, "generated document does not fit\n");
+        exit(1);
+    }
+    memcpy(t->data + t->length, s, length);
+    t->length += length;
+}
+
+static void _append_string(TEXT *t, const char *s)
+{
+    _append(t, s, strlen(s));
+}
+
+/* size bytes of records with 4 KiB strings, one of them a quarter long */
+static void _flat(TEXT *t, size_t size)
+{
+    static const char words[] = "alpha bravo charlie delta echo foxtrot ";
+    char name[32];
+    unsigned long n;
+
+    for (n = 0; t->length + (n <= 8 ? size / 4 : 0) + 8192 < size; n++)
+    {
+        size_t length = n == 8 ? size / 4 : 4096;
+
+        sprintf(name, "text%lu \"", n);
+        _append_string(t, name);
+        for (; length >= sizeof(words) - 1; length -= sizeof(words) - 1)
+            _append(t, words, sizeof(words) - 1);
+        _append_string(t, "\";\n");
+    }
+}
+
+/* depth nested groups, each one opened by a section */
+static void _deep(TEXT *t, unsigned long depth)
+{
+    unsigned long i;
+
+    _append_string(t, "tree\n");
+    for (i = 0; i < depth; i++)
+        _append_string(t, "k (\n");
+    _append_string(t, "leaf x;\n");
+    for (i = 0; i < depth; i++)
+        _append_string(t, "),\n");
+    _append_string(t, ",\n");
+}
+
+static unsigned long _log2(size_t n)
+{
+    unsigned long bits = 0;
+
+    while (n >>= 1)
+        bits++;
+
+    return bits + 1;
+}
+
+/* parses t with a new parser, reserving room first when reserve is set */
+static int _check(const char *name, const TEXT *t, int reserve)
+{
+    SNOT_PARSER *p = _create();
+    SNOT_RESULT result;
+    unsigned long limit = reserve ? 0 : 2 * _log2(t->length);
+
+    if (!p)
+    {
+        fprintf(stderr, "%s: cannot create a parser\n", name);
+        return 1;
+    }
+
+    /* a value takes at least one byte and its terminator one more */
+    if (reserve &&
+        snot_reserve(p, t->length + 16, 2 * t->length + 16) != SNOT_OK)
+    {
+        fprintf(stderr, "%s: snot_reserve failed\n", name);
+        snot_free(p);
+        return 1;
+    }
+
+    _grows = 0;
+    result = snot_parse_buffer(p, t->data, t->length, NULL);
+    if (result == SNOT_OK)
+        result = snot_end(p);
+    snot_free(p);
+
+    printf("%-16s %10lu bytes %4lu grow calls, at most %lu\n",
+           name,
+           (unsigned long)t->length,
+           _grows,
+           limit);
+
+    if (result != SNOT_OK)
+    {
+        fprintf(stderr, "%s: %s\n", name, snot_result_string(result));
+        return 1;
+    }
+    if (_grows > limit)
+    {
+        fprintf(stderr, "%s: too many grow calls\n", name);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    TEXT flat, deep, small;
+    int failed = 0;
+
+    flat.length    = 0;
+    flat.capacity  = 100UL << 20;
+    flat.data      = (char *)malloc(flat.capacity);
+    deep.length    = 0;
+    deep.capacity  = 8UL << 20;
+    deep.data      = (char *)malloc(deep.capacity);
+    small.length   = 0;
+    small.capacity = 1UL << 20;
+    small.data     = (char *)malloc(small.capacity);
+    if (!flat.data || !deep.data || !small.data)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    _flat(&flat, flat.capacity);
+    _deep(&deep, 1000000UL);
+    _flat(&small, small.capacity / 2);
+    _deep(&small, 20000UL);
+
+    failed |= _check("flat", &flat, 0);
+    failed |= _check("deep", &deep, 0);
+    failed |= _check("small", &small, 0);
+    failed |= _check("small reserved", &small, 1);
+
+    free(flat.data);
+    free(deep.data);
+    free(small.data);
+
+    return failed;
+}
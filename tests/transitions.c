@@ -0,0 +1,140 @@
+/*
+ * Checks that every cell of the hand-written _snot_transitions table is
+ * reached: each state is entered through a short prefix, then fed a code
+ * point of every class. Cells marked as errors must reject it.
+ *
+ * The parser is built into this file so its tables are visible here.
+ */
+#define SNOT_STATIC
+#include <snot.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* input leading to each state, in SNOT_STATE order */
+static const char *const _prefixes[SNOT_STATE_COUNT] = {
+    "",             /* SNOT_STATE_VALUE */
+    "a",            /* SNOT_STATE_IDENTIFIER */
+    "\"a",          /* SNOT_STATE_STRING */
+    "\"a\\",        /* SNOT_STATE_ESCAPE */
+    "\"a\"\\",      /* SNOT_STATE_CONTINUE */
+    "0",            /* SNOT_STATE_ZERO */
+    "1",            /* SNOT_STATE_DEC */
+    "1.",           /* SNOT_STATE_DOT */
+    "1.5",          /* SNOT_STATE_REAL */
+    "0x",           /* SNOT_STATE_HEX_PREFIX */
+    "0x1",          /* SNOT_STATE_HEX */
+    "01",           /* SNOT_STATE_OCT */
+    "\"\\1",        /* SNOT_STATE_ESCAPE_OCT */
+    "\"\\x",        /* SNOT_STATE_ESCAPE_HEX */
+    "\"\\uD800",    /* SNOT_STATE_SURROGATE */
+    "\"\\uD800\\"}; /* SNOT_STATE_SURROGATE_U */
+
+/* code points past ASCII, covering whitespace and invalid ones */
+static const uint32_t _extra[] = {
+    0xA0, 0xE9, 0x2028, 0xD800, 0xFFFE, 0x1F600};
+
+static void _event(SNOT_PARSER *p, size_t id, void *userdata)
+{
+    (void)p;
+    (void)id;
+    (void)userdata;
+}
+
+static void *_grow(void *memory, size_t *size, size_t grow_size)
+{
+    *size += grow_size;
+    return realloc(memory, *size);
+}
+
+/* feeds the prefix of state to a reset parser, 0 when it does not get there */
+static int _enter(SNOT_PARSER *p, unsigned int state)
+{
+    const char *s;
+
+    snot_reset(p);
+    for (s = _prefixes[state]; *s; s++)
+        if (snot_parse(p, (unsigned char)*s) != SNOT_OK)
+            return 0;
+
+    return p->state == state;
+}
+
+int main(void)
+{
+    static unsigned char covered[SNOT_STATE_COUNT][SNOT_CLASS_COUNT];
+    SNOT_CALLBACKS cx;
+    SNOT_PARSER *p;
+    SNOT_RESULT result;
+    unsigned int state, cls, i, count;
+    uint32_t c;
+    int failed = 0;
+
+    cx.alloc         = malloc;
+    cx.free          = free;
+    cx.grow          = _grow;
+    cx.shrink        = NULL;
+    cx.start_section = _event;
+    cx.end_section   = _event;
+    cx.string        = _event;
+    cx.number        = _event;
+
+    p = snot_create(cx, NULL);
+    if (!p)
+    {
+        fprintf(stderr, "cannot create a parser\n");
+        return 1;
+    }
+
+    count = 0x80 + sizeof(_extra) / sizeof(_extra[0]);
+    for (state = 0; state < SNOT_STATE_COUNT; state++)
+    {
+        for (i = 0; i < count; i++)
+        {
+            c = i < 0x80 ? i : _extra[i - 0x80];
+
+            if (!_enter(p, state))
+            {
+                fprintf(stderr, "prefix of state %u fails\n", state);
+                failed = 1;
+                break;
+            }
+
+            cls                 = _snot_class_of(c);
+            covered[state][cls] = 1;
+            result              = snot_parse(p, c);
+
+            if (_snot_transitions[state][cls] >> 4 == SNOT_ACTION_ERROR &&
+                result != SNOT_ERROR_INVALID_CHARACTER)
+            {
+                fprintf(stderr,
+                        "state %u accepts U+%04lX of class %u\n",
+                        state,
+                        (unsigned long)c,
+                        cls);
+                failed = 1;
+            }
+        }
+    }
+
+    for (state = 0; state < SNOT_STATE_COUNT; state++)
+    {
+        for (cls = 0; cls < SNOT_CLASS_COUNT; cls++)
+        {
+            if (!covered[state][cls])
+            {
+                fprintf(stderr, "state %u, class %u not reached\n", state, cls);
+                failed = 1;
+            }
+        }
+    }
+
+    snot_free(p);
+
+    if (!failed)
+        printf("%u states, %u classes, every transition reached\n",
+               (unsigned int)SNOT_STATE_COUNT,
+               (unsigned int)SNOT_CLASS_COUNT);
+
+    return failed;
+}